@@ -0,0 +1,86 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "CFU.hh"
+
+namespace {
+
+/** @brief Per-lane reference: signed 16-bit product of byte lane `_lane`, zero-extended */
+uint32_t laneProduct(uint32_t _a, uint32_t _b, int _lane) {
+	int32_t a = static_cast<int8_t>(_a >> (_lane * 8));
+	int32_t b = static_cast<int8_t>(_b >> (_lane * 8));
+	return static_cast<uint16_t>(a * b);
+}
+
+uint32_t reference(instr_enum _op, uint32_t a, uint32_t b) {
+	switch (_op) {
+		case S_PMULI8I16S_VV_L: return laneProduct(a, b, 0) | laneProduct(a, b, 1) << 16;
+		case S_PMULI8I16S_VV_H: return laneProduct(a, b, 2) | laneProduct(a, b, 3) << 16;
+		case S_AMULI8I8S_VV_NQ:
+			return laneProduct(a, b, 0) >> 8 | (laneProduct(a, b, 1) & 0xFF00u) |
+			       (laneProduct(a, b, 2) & 0xFF00u) << 8 | (laneProduct(a, b, 3) & 0xFF00u) << 16;
+		case S_AMULI8I8S_VV_L:
+			return (laneProduct(a, b, 0) & 0xFFu) | (laneProduct(a, b, 1) & 0xFFu) << 8 |
+			       (laneProduct(a, b, 2) & 0xFFu) << 16 | laneProduct(a, b, 3) << 24;
+		default: return 0;
+	}
+}
+
+uint32_t run(MulUnit& _unit, instr_enum _op, uint32_t _a, uint32_t _b) {
+	_unit.setInstrType(_op);
+	_unit.setOperands(_a, _b);
+	_unit.computation();
+	return _unit.getResult();
+}
+
+// Extreme lanes first, so -128 * -128 and -128 * 127 are always covered
+constexpr uint32_t kCorners[] = {0x00000000u, 0x80808080u, 0x7F7F7F7Fu, 0xFFFFFFFFu, 0x807F01FFu, 0x7F80FF01u};
+
+}  // namespace
+
+TEST(CFUMulUnit, PackedMultipliesMatchThePerLaneReference) {
+	MulUnit          unit(nullptr);
+	std::mt19937     rng(1);
+	const instr_enum ops[] = {S_PMULI8I16S_VV_L, S_PMULI8I16S_VV_H, S_AMULI8I8S_VV_NQ, S_AMULI8I8S_VV_L};
+	for (instr_enum op : ops) {
+		for (uint32_t a : kCorners) {
+			for (uint32_t b : kCorners) {
+				ASSERT_EQ(run(unit, op, a, b), reference(op, a, b)) << std::hex << a << " " << b;
+			}
+		}
+		for (int n = 0; n < 100000; n++) {
+			uint32_t a = rng(), b = rng();
+			ASSERT_EQ(run(unit, op, a, b), reference(op, a, b)) << std::hex << a << " " << b;
+		}
+	}
+}
+
+TEST(CFUMulUnit, Mac4AccumulatesTheLaneDotProduct) {
+	MulUnit      unit(nullptr);
+	std::mt19937 rng(2);
+	int32_t      acc = 0;
+	for (int n = 0; n < 100000; n++) {
+		uint32_t a = rng(), b = rng();
+		for (int lane = 0; lane < 4; lane++) { acc += static_cast<int16_t>(laneProduct(a, b, lane)); }
+		ASSERT_EQ(run(unit, MAC4, a, b), static_cast<uint32_t>(acc));
+	}
+	EXPECT_EQ(run(unit, RDACC, 0, 0), static_cast<uint32_t>(acc));
+	EXPECT_EQ(run(unit, RDACC, 0, 0), 0u);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Emulator.hh"
+
+namespace {
+
+instr decodeWord(uint32_t _word, uint32_t _pc = 0) {
+	instr i;
+	EXPECT_TRUE(Emulator::decode(_word, _pc, &i)) << std::hex << _word;
+	return i;
+}
+
+}  // namespace
+
+TEST(EmulatorDecode, RType) {
+	instr i = decodeWord(0x002081b3);  // add x3, x1, x2
+	EXPECT_EQ(i.op, ADD);
+	EXPECT_EQ(i.a1.reg, 3);
+	EXPECT_EQ(i.a2.reg, 1);
+	EXPECT_EQ(i.a3.reg, 2);
+}
+
+TEST(EmulatorDecode, ITypeSignExtendsImmediate) {
+	instr i = decodeWord(0xfff00093);  // addi x1, x0, -1
+	EXPECT_EQ(i.op, ADDI);
+	EXPECT_EQ(i.a1.reg, 1);
+	EXPECT_EQ(i.a2.reg, 0);
+	EXPECT_EQ(i.a3.imm, 0xffffffffu);
+}
+
+TEST(EmulatorDecode, SType) {
+	instr i = decodeWord(0x0020a423);  // sw x2, 8(x1)
+	EXPECT_EQ(i.op, SW);
+	EXPECT_EQ(i.a1.reg, 2);
+	EXPECT_EQ(i.a2.reg, 1);
+	EXPECT_EQ(i.a3.imm, 8u);
+}
+
+TEST(EmulatorDecode, BTypeTargetIsAbsolute) {
+	instr fwd = decodeWord(0x00208463, 0x100);  // beq x1, x2, +8
+	EXPECT_EQ(fwd.op, BEQ);
+	EXPECT_EQ(fwd.a1.reg, 1);
+	EXPECT_EQ(fwd.a2.reg, 2);
+	EXPECT_EQ(fwd.a3.imm, 0x108u);
+
+	instr back = decodeWord(0xfe209ee3, 0x100);  // bne x1, x2, -4
+	EXPECT_EQ(back.op, BNE);
+	EXPECT_EQ(back.a3.imm, 0xfcu);
+}
+
+TEST(EmulatorDecode, UType) {
+	instr i = decodeWord(0x123452b7);  // lui x5, 0x12345
+	EXPECT_EQ(i.op, LUI);
+	EXPECT_EQ(i.a1.reg, 5);
+	EXPECT_EQ(i.a2.imm, 0x12345u);
+}
+
+TEST(EmulatorDecode, JTypeTargetIsAbsolute) {
+	instr i = decodeWord(0x010000ef, 0x200);  // jal x1, +16
+	EXPECT_EQ(i.op, JAL);
+	EXPECT_EQ(i.a1.reg, 1);
+	EXPECT_EQ(i.a2.imm, 0x210u);
+}
+
+TEST(EmulatorDecode, Custom0ScalarCfuOps) {
+	instr add = decodeWord(0x0220818b);  // funct7 = 1: s.addi16i16s.vv x3, x1, x2
+	EXPECT_EQ(add.op, S_ADDI16I16S_VV);
+	EXPECT_EQ(add.a1.reg, 3);
+	EXPECT_EQ(add.a2.reg, 1);
+	EXPECT_EQ(add.a3.reg, 2);
+
+	instr mac = decodeWord(0x0020928b);  // mac4 x1, x2; rd is forced to x0
+	EXPECT_EQ(mac.op, MAC4);
+	EXPECT_EQ(mac.a1.reg, 0);
+	EXPECT_EQ(mac.a2.reg, 1);
+	EXPECT_EQ(mac.a3.reg, 2);
+}
+
+TEST(EmulatorDecode, Custom1VectorCfuOps) {
+	instr vl = decodeWord(0x010100ab);  // vl128 v1, 16(x2)
+	EXPECT_EQ(vl.op, VL128);
+	EXPECT_EQ(vl.a1.reg, 1);
+	EXPECT_EQ(vl.a2.reg, 2);
+	EXPECT_EQ(vl.a3.imm, 16u);
+
+	instr vsub = decodeWord(0x043130ab);  // funct7 = 2: v.subi8i8s.vv v1, v2, v3
+	EXPECT_EQ(vsub.op, V_SUBI8I8S_VV);
+	EXPECT_EQ(vsub.a1.reg, 1);
+	EXPECT_EQ(vsub.a2.reg, 2);
+	EXPECT_EQ(vsub.a3.reg, 3);
+}
+
+TEST(EmulatorDecode, RejectsUnimplementedWords) {
+	instr i;
+	EXPECT_FALSE(Emulator::decode(0x010104ab, 0, &i));  // vl128 into v9, past the vector register file
+	EXPECT_EQ(i.op, UNIMPL);
+	EXPECT_FALSE(Emulator::decode(0xffffffff, 0, &i));
+	EXPECT_EQ(i.op, UNIMPL);
+}
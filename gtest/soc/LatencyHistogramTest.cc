@@ -0,0 +1,66 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "LatencyHistogram.hh"
+
+TEST(LatencyHistogram, SmallLatenciesAreExact) {
+	LatencyHistogram hist;
+	for (acalsim::Tick t = 1; t <= 20; t++) { hist.record(t); }
+	EXPECT_EQ(hist.count(), 20u);
+	EXPECT_EQ(hist.percentile(0.50), 10u);
+	EXPECT_EQ(hist.percentile(0.95), 19u);
+	EXPECT_EQ(hist.max(), 20u);
+}
+
+TEST(LatencyHistogram, BucketsAreContiguous) {
+	for (size_t b = 1; b + 1 < LatencyHistogram::kNumBuckets; b++) {
+		acalsim::Tick first = LatencyHistogram::upperBound(b - 1) + 1;
+		EXPECT_EQ(LatencyHistogram::bucketOf(first), b);
+		EXPECT_EQ(LatencyHistogram::bucketOf(LatencyHistogram::upperBound(b)), b);
+	}
+	EXPECT_EQ(LatencyHistogram::bucketOf(LatencyHistogram::kMaxTracked + 1000), LatencyHistogram::kNumBuckets - 1);
+}
+
+TEST(LatencyHistogram, PercentilesStayWithinOneSixteenthOfTheExactValue) {
+	std::mt19937_64                              rng(7);
+	std::uniform_int_distribution<acalsim::Tick> dist(1, 100000);
+	std::vector<acalsim::Tick>                   samples;
+	LatencyHistogram                             hist;
+	for (int n = 0; n < 10000; n++) {
+		samples.push_back(dist(rng));
+		hist.record(samples.back());
+	}
+	std::sort(samples.begin(), samples.end());
+	for (double p : {0.50, 0.95, 0.99}) {
+		acalsim::Tick exact = samples[(size_t)std::ceil(p * samples.size()) - 1];
+		EXPECT_GE(hist.percentile(p), exact);
+		EXPECT_LE(hist.percentile(p), exact + exact / 16);
+	}
+	EXPECT_EQ(hist.percentile(1.0), samples.back());
+}
+
+TEST(LatencyHistogram, EmptyHistogramReportsZero) {
+	LatencyHistogram hist;
+	EXPECT_EQ(hist.percentile(0.99), 0u);
+	EXPECT_EQ(hist.max(), 0u);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "MemoryOrder.hh"
+
+namespace {
+
+constexpr acalsim::Tick kReadLatency  = 5;
+constexpr acalsim::Tick kWriteLatency = 1;
+
+}  // namespace
+
+TEST(MemoryOrder, StoreAfterLoadToTheSameWordWaitsForTheLoad) {
+	// lw t0, 0(a0); sw zero, 0(a0) granted on consecutive ticks
+	MemoryOrder order;
+	EXPECT_EQ(order.schedule(10, 10 + kReadLatency, 0x2000, 4, false), 15u);
+	EXPECT_EQ(order.schedule(11, 11 + kWriteLatency, 0x2000, 4, true), 15u);
+}
+
+TEST(MemoryOrder, StoreAfterAmoWaitsForTheAmo) {
+	MemoryOrder order;
+	EXPECT_EQ(order.schedule(0, kReadLatency, 0x2000, 4, true), kReadLatency);
+	EXPECT_EQ(order.schedule(0, kWriteLatency, 0x2000, 4, true), kReadLatency);
+}
+
+TEST(MemoryOrder, LoadAfterStoreWaitsForTheStore) {
+	// Reads faster than writes
+	MemoryOrder order;
+	EXPECT_EQ(order.schedule(0, 8, 0x2000, 4, true), 8u);
+	EXPECT_EQ(order.schedule(0, 2, 0x2002, 4, false), 8u);
+}
+
+TEST(MemoryOrder, OtherAddressesKeepTheirLatency) {
+	MemoryOrder order;
+	EXPECT_EQ(order.schedule(0, kReadLatency, 0x2000, 4, false), kReadLatency);
+	EXPECT_EQ(order.schedule(0, kWriteLatency, 0x2004, 4, true), kWriteLatency);
+	EXPECT_EQ(order.schedule(0, kWriteLatency, 0x1ffc, 4, true), kWriteLatency);
+}
+
+TEST(MemoryOrder, LoadsDoNotOrderEachOther) {
+	MemoryOrder order;
+	EXPECT_EQ(order.schedule(0, 9, 0x2000, 4, false), 9u);
+	EXPECT_EQ(order.schedule(0, 3, 0x2000, 4, false), 3u);
+}
+
+TEST(MemoryOrder, PerformedBeatsAreForgotten) {
+	MemoryOrder order;
+	EXPECT_EQ(order.schedule(0, kReadLatency, 0x2000, 4, false), kReadLatency);
+	// The load was performed at tick 5, so a store granted at tick 6 keeps its own latency
+	EXPECT_EQ(order.schedule(6, 6 + kWriteLatency, 0x2000, 4, true), 7u);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+
+#include "ProgramImage.hh"
+
+namespace {
+
+constexpr uint64_t kKey = 0x0123456789abcdefull;
+
+class ProgramImageTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		auto name  = "program_image_test." + std::to_string(getpid()) + ".img";
+		this->path = (std::filesystem::temp_directory_path() / name).string();
+
+		this->imem[0].op     = ADDI;
+		this->imem[0].a1.reg = 1;
+		this->imem[0].a3.imm = 42;
+		this->imem[0].src    = {10, 20};
+		this->imem[1].op     = HCF;
+
+		this->contents.imem     = this->imem;
+		this->contents.segments = {{0x2000, this->data}};
+		this->contents.symbols  = {{"main", 0}, {"buffer", 0x2000}, {"missing", -1}};
+		this->contents.memoff   = 8;
+		this->contents.dataEnd  = 0x2005;
+	}
+
+	void TearDown() override { std::filesystem::remove(this->path); }
+
+	std::string            path;
+	std::array<instr, 2>   imem{};
+	std::array<uint8_t, 5> data = {1, 2, 3, 4, 5};
+	ProgramImage::Contents contents;
+};
+
+}  // namespace
+
+TEST_F(ProgramImageTest, RoundTrip) {
+	ASSERT_TRUE(ProgramImage::write(this->path, kKey, this->contents));
+
+	ProgramImage image;
+	ASSERT_TRUE(image.map(this->path, kKey));
+	const ProgramImage::Contents& loaded = image.contents();
+
+	ASSERT_EQ(loaded.imem.size(), this->imem.size());
+	EXPECT_EQ(loaded.imem[0].op, ADDI);
+	EXPECT_EQ(loaded.imem[0].a1.reg, 1);
+	EXPECT_EQ(loaded.imem[0].a3.imm, 42u);
+	EXPECT_EQ(loaded.imem[0].src.offset, 10u);
+	EXPECT_EQ(loaded.imem[0].src.len, 20u);
+	EXPECT_EQ(loaded.imem[1].op, HCF);
+
+	ASSERT_EQ(loaded.segments.size(), 1u);
+	EXPECT_EQ(loaded.segments[0].addr, 0x2000u);
+	EXPECT_TRUE(std::equal(loaded.segments[0].bytes.begin(), loaded.segments[0].bytes.end(), this->data.begin(),
+	                       this->data.end()));
+
+	EXPECT_EQ(loaded.symbols, this->contents.symbols);
+	EXPECT_EQ(loaded.memoff, 8);
+	EXPECT_EQ(loaded.dataEnd, 0x2005);
+
+	image.unmap();
+	EXPECT_TRUE(image.contents().imem.empty());
+}
+
+TEST_F(ProgramImageTest, RejectsAnotherKey) {
+	ASSERT_TRUE(ProgramImage::write(this->path, kKey, this->contents));
+
+	ProgramImage image;
+	EXPECT_FALSE(image.map(this->path, kKey + 1));
+	EXPECT_TRUE(image.contents().imem.empty());
+	EXPECT_TRUE(image.map(this->path, kKey));
+}
+
+TEST_F(ProgramImageTest, RejectsAnotherVersion) {
+	ASSERT_TRUE(ProgramImage::write(this->path, kKey, this->contents));
+
+	// The version follows the 8-byte magic at the start of the header
+	uint32_t version = ProgramImage::kVersion + 1;
+	{
+		std::fstream file(this->path, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(8);
+		file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	}
+
+	ProgramImage image;
+	EXPECT_FALSE(image.map(this->path, kKey));
+}
+
+TEST_F(ProgramImageTest, RejectsMissingFile) {
+	ProgramImage image;
+	EXPECT_FALSE(image.map(this->path, kKey));
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "SymbolTable.hh"
+
+TEST(SymbolTable, InternReturnsOneIdPerName) {
+	SymbolTable table;
+	auto        loop = table.intern("loop");
+	auto        done = table.intern("done");
+	EXPECT_NE(loop, done);
+	EXPECT_EQ(table.intern("loop"), loop);
+	EXPECT_EQ(table.size(), 2u);
+	EXPECT_EQ(table.name(loop), "loop");
+	EXPECT_EQ(table.name(done), "done");
+}
+
+TEST(SymbolTable, InternCopiesTheName) {
+	SymbolTable table;
+	std::string name = "buffer";
+	auto        id   = table.intern(name);
+	name             = "clobbered";
+	EXPECT_EQ(table.name(id), "buffer");
+	EXPECT_EQ(table.intern("buffer"), id);
+}
+
+TEST(SymbolTable, ReferenceBeforeDefinition) {
+	SymbolTable table;
+	auto        id = table.intern("later");
+	EXPECT_FALSE(table.isDefined(id));
+	EXPECT_TRUE(table.define(id, 0x40));
+	EXPECT_TRUE(table.isDefined(id));
+	EXPECT_EQ(table.location(id), 0x40u);
+}
+
+TEST(SymbolTable, RedefinitionKeepsTheFirstLocation) {
+	SymbolTable table;
+	auto        id = table.intern("main");
+	EXPECT_TRUE(table.define(id, 0x10));
+	EXPECT_FALSE(table.define(id, 0x20));
+	EXPECT_EQ(table.location(id), 0x10u);
+}
+
+TEST(SymbolTable, ClearForgetsEveryLabel) {
+	SymbolTable table;
+	table.define(table.intern("a"), 4);
+	table.intern("b");
+	table.clear();
+	EXPECT_EQ(table.size(), 0u);
+	auto id = table.intern("b");
+	EXPECT_EQ(id, 0u);
+	EXPECT_FALSE(table.isDefined(id));
+}
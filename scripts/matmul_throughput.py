@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+# Copyright 2023-2024 Playlab/ACAL
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from typing import List, Optional, Tuple
+import os
+import re
+import subprocess
+
+import click
+
+# Every kernel multiplies two 32x32 int8 matrices
+MACS: int = 32 * 32 * 32
+PROGRAMS: List[str] = [
+    "soc/asm/matmul_simd.s",
+    "soc/asm/matmul_vector.s",
+    "soc/asm/matmul_mac.s",
+    "soc/asm/program_systolic_array.s",
+]
+
+# Regular expressions
+COLOR_REGEX: re.Pattern = re.compile(r"\033\[[0-9;]+m")
+TIMETICK_REGEX: re.Pattern = re.compile(r"Tick=(\d+) Info: \[.+\] Simulation complete\.")
+
+
+def move_to_root_dir() -> None:
+	os.chdir(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+
+def run_program(binary: str, program: str, timeout: Optional[float]) -> Optional[int]:
+	proc = subprocess.run(
+	    [binary, "--asm_file_path", program],
+	    timeout=timeout,
+	    stdout=subprocess.PIPE,
+	    stderr=subprocess.STDOUT,
+	    text=True,
+	    check=True
+	)
+
+	sim_complete_tick: Optional[int] = None
+	for line in proc.stdout.splitlines():
+		m = re.search(TIMETICK_REGEX, COLOR_REGEX.sub("", line))
+		sim_complete_tick = int(m.group(1)) if m else sim_complete_tick
+	return sim_complete_tick
+
+
+@click.command()
+@click.option("--binary", default="build/debug/bin/soc", show_default=True, help="Path of the soc executable.")
+@click.option("--timeout", default=None, type=float, help="Timeout of each simulation in seconds.")
+def main(binary: str, timeout: Optional[float]) -> None:
+	move_to_root_dir()
+
+	results: List[Tuple[str, Optional[int]]] = []
+	for program in PROGRAMS:
+		results.append((os.path.basename(program), run_program(binary, program, timeout)))
+
+	width: int = max(len(name) for name, _ in results) + 2
+	print(f"| {'Program'.ljust(width)} | MACs  | Ticks      | MACs / tick |")
+	print(f"| {'-' * width} | ----- | ---------- | ----------- |")
+	for name, ticks in results:
+		ticks_str: str = str(ticks) if ticks else "n/a"
+		rate_str: str = f"{MACS / ticks:.3f}" if ticks else "n/a"
+		print(f"| {('`' + name + '`').ljust(width)} | {MACS} | {ticks_str.ljust(10)} | {rate_str.ljust(11)} |")
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,51 @@
+# Copyright 2023-2024 Playlab/ACAL
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+## Multi-core synchronization test
+## Run it on every core of the cluster. Each core adds 1 to `counter` 16 times with amoadd.w,
+## and 16 times to `locked_sum` with a plain lw / addi / sw guarded by an amoswap.w spinlock.
+## With N cores both words end at 16 * N.
+
+.data
+counter:
+.word 0
+locked_sum:
+.word 0
+lock:
+.word 0
+
+.text
+la      s0, counter
+la      s1, locked_sum
+la      s2, lock
+addi    t0, x0, 16
+addi    t1, x0, 1
+
+loop:
+amoadd.w  x0, t1, (s0)
+
+acquire:
+amoswap.w t2, t1, (s2)
+bne       t2, x0, acquire
+lw        t3, 0(s1)
+addi      t3, t3, 1
+sw        t3, 0(s1)
+## make the update visible before the lock is released
+fence
+amoswap.w x0, x0, (s2)
+
+addi    t0, t0, -1
+bne     t0, x0, loop
+fence
+hcf
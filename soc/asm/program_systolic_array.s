@@ -1,14 +1,40 @@
 .data
 ## allocate memory space for Martix A, B, C data in shared data memory. (start from 0x8000)
+## A and B are 32x32 uint8, so the accelerator runs the same 32 * 32 * 32 = 32768 MACs as matmul_simd.s,
+## matmul_vector.s and matmul_mac.s.
 mat_A:
-.byte 1 4 5 3 1 2 3 4
-.byte 1 4 2 2 2 1 2 3
-.byte 5 5 3 3 2 1 3 2
-.byte 4 3 1 5 2 5 1 3
-.byte 1 4 5 3 1 2 3 4
-.byte 1 4 2 2 2 1 2 3
-.byte 5 5 3 3 2 1 3 2
-.byte 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
+.byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
+.byte 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3 1 4 2 2 2 1 2 3
+.byte 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2 5 5 3 3 2 1 3 2
+.byte 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3 4 3 1 5 2 5 1 3
 
 mat_B:
 .byte 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4 1 4 5 3 1 2 3 4
@@ -171,8 +197,8 @@ la t6, ACCEL_MATA_SIZE
 lw t1, 0(t6)
 ## t1 = 0x12000 + 0x8
 add t1, t1, t0
-li t2, 0x00070007
-## store 0x00003003 into mem[0x12008]
+li t2, 0x001F001F
+## store 0x001F001F (M = K = 32) into mem[0x12008]
 sw t2, 0(t1)
 
 ## 5. Program ACCEL_MATB_SIZE reg
@@ -181,8 +207,8 @@ la t6, ACCEL_MATB_SIZE
 lw t1, 0(t6)
 ## t1 = 0x12000 + 0xC
 add t1, t1, t0
-## store 0x00030003 into mem[0x1200C]
-li t2, 0x00070007
+## store 0x001F001F (K = N = 32) into mem[0x1200C]
+li t2, 0x001F001F
 sw t2, 0(t1)
 
 ## 6. Program ACCEL_MATC_SIZE reg
@@ -191,8 +217,8 @@ la t6, ACCEL_MATC_SIZE
 lw t1, 0(t6)
 ## t1 = 0x12000 + 0x10
 add t1, t1, t0
-## store 0x00030003 into mem[0x12010]
-li t2, 0x00070007
+## store 0x001F001F (M = N = 32) into mem[0x12010]
+li t2, 0x001F001F
 sw t2, 0(t1)
 
 ## 7. Program MAT_MEM_STRIDE reg
@@ -201,8 +227,8 @@ la t6, ACCEL_OFFSET_MAT_MEM_STRIDE
 lw t1, 0(t6)
 ## t1 = 0x12000 + 0x20
 add t1, t1, t0
-## store 0x00040404 into mem[0x12020]
-li t2, 0x00080808
+## store 0x00202020 (32-byte rows) into mem[0x12020]
+li t2, 0x00202020
 sw t2, 0(t1)
 
 
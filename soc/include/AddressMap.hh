@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_ADDRESSMAP_HH_
+#define SOC_INCLUDE_ADDRESSMAP_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One contiguous address range routed to a CrossBar slave
+ */
+struct AddressRegion {
+	std::string name;       ///< Used in logs and error messages only
+	uint32_t    base  = 0;  ///< First byte address of the region
+	uint64_t    size  = 0;  ///< Length in bytes
+	size_t      slave = 0;  ///< CrossBar slave (response port) index that serves the region
+};
+
+/**
+ * @class AddressMap
+ * @brief Decodes a bus address into the index of the slave that owns it
+ * @details The regions come from the "AddressMap" section of `configs.json`. `build()` sorts them by base address
+ *          and rejects overlaps, so `decode()` is a single binary search no matter how many regions are declared.
+ *          Addresses outside every region go to the default slave (the data memory).
+ */
+class AddressMap {
+public:
+	/**
+	 * @brief Compile the region list into the lookup table
+	 * @param _regions Declared regions, in any order
+	 * @param _default_slave Slave that serves addresses not covered by any region
+	 * @param _num_slaves Number of slave ports on the CrossBar, used to validate the slave indices
+	 */
+	void build(std::vector<AddressRegion> _regions, size_t _default_slave, size_t _num_slaves);
+
+	/**
+	 * @brief Slave index serving `_addr`
+	 */
+	size_t decode(uint32_t _addr) const;
+
+	/**
+	 * @brief Lowest region served by `_slave`, or nullptr when the slave only gets default-routed addresses
+	 */
+	const AddressRegion* findSlave(size_t _slave) const;
+
+	const std::vector<AddressRegion>& getRegions() const { return this->regions; }
+	size_t                            getDefaultSlave() const { return this->defaultSlave; }
+
+private:
+	std::vector<AddressRegion> regions;  ///< sorted by base, non-overlapping
+	std::vector<uint32_t>      bases;    ///< regions[i].base, kept apart for a cache-friendly search
+	size_t                     defaultSlave = 0;
+};
+
+#endif  // SOC_INCLUDE_ADDRESSMAP_HH_
@@ -19,6 +19,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
 
 #include "ACALSim.hh"
 
@@ -32,6 +35,9 @@ public:
 	BaseMemory(size_t _size);
 	~BaseMemory();
 
+	BaseMemory(const BaseMemory&)            = delete;
+	BaseMemory& operator=(const BaseMemory&) = delete;
+
 	/**
 	 * @brief Get the size of this memory in bytes.
 	 *
@@ -40,17 +46,49 @@ public:
 	size_t getSize() const;
 
 	/**
-	 * @brief Read the data from this memory.
+	 * @brief Get a read-only view of a memory region.
+	 *
+	 * @param _addr The starting address of the region.
+	 * @param _size The size of the region in bytes.
+	 * @return std::span<const std::byte> A view that aliases the memory; no data is copied.
+	 */
+	std::span<const std::byte> view(uint32_t _addr, size_t _size) const;
+
+	/**
+	 * @brief Get a writable view of a memory region.
+	 *
+	 * @param _addr The starting address of the region.
+	 * @param _size The size of the region in bytes.
+	 * @return std::span<std::byte> A view that aliases the memory; no data is copied.
+	 */
+	std::span<std::byte> view(uint32_t _addr, size_t _size);
+
+	/**
+	 * @brief Load a trivially copyable value from memory (unaligned accesses are allowed).
 	 *
-	 * @param _addr The starting address of the read operation.
-	 * @param _size The size of the data in bytes.
-	 * @param _deep_copy Create a duplicate of the target data. Default is `false`.
-	 * @return void* The pointer that points to the asked data.
+	 * @tparam T The type of the value, e.g. `int8_t` or `uint32_t`.
+	 * @param _addr The address of the value.
+	 */
+	template <typename T>
+	T load(uint32_t _addr) const {
+		static_assert(std::is_trivially_copyable_v<T>);
+		T value;
+		std::memcpy(&value, this->view(_addr, sizeof(T)).data(), sizeof(T));
+		return value;
+	}
+
+	/**
+	 * @brief Store a trivially copyable value into memory (unaligned accesses are allowed).
 	 *
-	 * @warning The caller should make sure all the operations against the returned data are within the asked size by
-	 * itself.
+	 * @tparam T The type of the value, e.g. `uint8_t` or `uint32_t`.
+	 * @param _addr The address of the value.
+	 * @param _value The value to be stored.
 	 */
-	void* readData(uint32_t _addr, size_t _size, bool _deep_copy = false) const;
+	template <typename T>
+	void store(uint32_t _addr, T _value) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		std::memcpy(this->view(_addr, sizeof(T)).data(), &_value, sizeof(T));
+	}
 
 	/**
 	 * @brief Write the given data into memory.
@@ -61,7 +99,7 @@ public:
 	 *
 	 * @warning If the `_size` exceeds the actual size of `_data`, some unknown data would be saved into memory.
 	 */
-	void writeData(void* _data, uint32_t _addr, size_t _size);
+	void writeData(const void* _data, uint32_t _addr, size_t _size);
 
 	void* getMemPtr() { return this->mem; }
 
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_BUSARBITER_HH_
+#define SOC_INCLUDE_BUSARBITER_HH_
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ACALSim.hh"
+
+/**
+ * @class BusArbiter
+ * @brief Picks which master is granted a shared slave resource next
+ * @details The owner keeps one request queue per master and passes the heads to `select()` whenever the resource
+ *          becomes free. The policies use the QoS level carried in each request:
+ *          - ROUND_ROBIN: rotate over the masters with a pending request, QoS is ignored
+ *          - FIXED_PRIORITY: highest QoS wins, ties go to the lower master index
+ *          - WEIGHTED_ROUND_ROBIN: round robin where master `m` may win `qos + 1` grants per round
+ *          - AGE: the request issued first wins, ties go to the lower master index
+ */
+class BusArbiter {
+public:
+	enum class Policy { ROUND_ROBIN, FIXED_PRIORITY, WEIGHTED_ROUND_ROBIN, AGE };
+
+	/**
+	 * @brief Head of one master's request queue
+	 */
+	struct Request {
+		bool          valid = false;  ///< The master has a pending request
+		uint8_t       qos   = 0;      ///< QoS level of the master, higher is more important
+		acalsim::Tick issue = 0;      ///< Tick the master issued the request
+	};
+
+	BusArbiter(Policy _policy = Policy::ROUND_ROBIN) : policy(_policy) {}
+
+	static Policy      parsePolicy(const std::string& _policy);
+	static const char* policyName(Policy _policy);
+
+	/**
+	 * @brief Choose the master to grant
+	 * @param _heads One entry per master; at least one must be valid
+	 * @return Index of the granted master
+	 */
+	size_t select(std::span<const Request> _heads);
+
+	Policy getPolicy() const { return this->policy; }
+
+private:
+	size_t selectRoundRobin(std::span<const Request> _heads);
+	size_t selectWeighted(std::span<const Request> _heads);
+
+	Policy                policy;
+	size_t                last = 0;  ///< last granted master (round robin pointer)
+	std::vector<uint32_t> credits;   ///< grants left in the current WRR round, per master
+};
+
+#endif  // SOC_INCLUDE_BUSARBITER_HH_
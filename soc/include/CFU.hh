@@ -1,7 +1,10 @@
 #ifndef SOC_INCLUDE_CFU_HH_
 #define SOC_INCLUDE_CFU_HH_
 
+#include <array>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "ACALSim.hh"
 #include "DataStruct.hh"
@@ -15,9 +18,24 @@ class MulUnit;
 
 enum class Unit_Decision { AddSub, Mul, Unknown };
 
+/**
+ * @class CFU
+ * @brief Pipelined custom function unit with an add/sub unit and a multiply unit
+ * @details Each unit has `CFU.issue_width` identical pipelines. An op starts on the pipeline of its unit that frees up
+ *          first, holds it for the op's initiation interval and returns its result `latency` ticks after it started.
+ *          Ops that arrive while every pipeline of their unit is busy wait in arrival order. Latency and initiation
+ *          interval are set per opcode in the "CFU" config section.
+ *
+ *          The `vs*` vector ops apply the matching packed op to all four 32-bit slices of two 128-bit vector registers
+ *          at once; they occupy one pipeline like a scalar op.
+ *
+ *          The multiply unit also holds a 32-bit accumulator: `mac4` adds the dot product of the four signed byte
+ *          lanes of its operands to it and `rdacc` returns it and clears it. An `rdacc` starts no earlier than the
+ *          result of the last `mac4` before it.
+ */
 class CFU : public acalsim::CPPSimBase {
 public:
-	CFU(std::string name) : CPPSimBase(name) {
+	CFU(std::string name) : CPPSimBase(name), cpuPort(name + "-m_cpu") {
 		LABELED_INFO(this->getName()) << "Constructing ...";
 		controller = std::make_unique<Controller>(this);
 		addSubUnit = std::make_unique<AddSubActivationUnit>(this);
@@ -25,16 +43,31 @@ public:
 	}
 	virtual ~CFU() {}
 
-	void                                  init() override { ; };
+	void                                  init() override;
 	void                                  step() override;
-	void                                  cleanup() override { ; };
+	void                                  cleanup() override;
 	void                                  packet_handler(CFUReqPacket* _pkt);
+	/** @brief Return an op's result to the CPU */
+	void                                  sendResult(CFURespPacket* _pkt);
 	uint32_t                              get_result(instr i, uint32_t rs1, uint32_t rs2);
 	std::unique_ptr<Controller>           controller;
 	std::unique_ptr<AddSubActivationUnit> addSubUnit;
 	std::unique_ptr<MulUnit>              mulUnit;
 
 private:
+	struct OpTiming {
+		acalsim::Tick latency = 1;  ///< Ticks from start to result
+		acalsim::Tick ii      = 1;  ///< Ticks the op holds its pipeline
+	};
+	static constexpr size_t kNumUnits = 2;  ///< Unit_Decision::AddSub and Unit_Decision::Mul
+
+	std::string                                       cpuPort;   ///< Channel port the results go out on
+	std::vector<OpTiming>                             timing;    ///< Indexed by instr_type
+	std::array<std::vector<acalsim::Tick>, kNumUnits> laneFree;  ///< Tick each pipeline of a unit accepts an op
+	std::array<uint64_t, kNumUnits>                   unitOps{};
+	acalsim::Tick structuralStall = 0;  ///< Ticks ops waited for a free pipeline
+	acalsim::Tick accReady        = 0;  ///< Tick the last mac4 has added into the accumulator
+
 	friend class Controller;
 	friend class AddSubActivationUnit;
 	friend class MulUnit;
@@ -85,6 +118,7 @@ private:
 	instr_enum           instr_type;
 	uint32_t             rs1, rs2;
 	uint32_t             result;
+	int32_t              acc = 0;  ///< MAC accumulator, read and cleared by RDACC
 	acalsim::CPPSimBase* sim;
 };
 
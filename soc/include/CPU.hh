@@ -17,17 +17,55 @@
 #ifndef SOC_INCLUDE_CPU_HH_
 #define SOC_INCLUDE_CPU_HH_
 
+#include <array>
+#include <deque>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "ACALSim.hh"
 #include "DMA.hh"
 #include "DataMemory.hh"
 #include "DataStruct.hh"
 #include "Emulator.hh"
+#include "L1DCache.hh"
 #include "MMIOUtil.hh"
 #include "packet/CFUPacket.hh"
 class BusMemWriteRespPacket;
 class BusMemReadRespPacket;
+class CPU;
+
+/**
+ * @brief Predecoded form of one `instr`
+ * @details `CPU::predecode()` builds one uop per instruction slot once the labels are resolved. A uop keeps only the
+ *          register numbers and a single immediate (branch and jump targets are already absolute), so it is 16 bytes
+ *          against the 68 bytes of an `instr` with its operand types and source span. The CPU executes a uop by
+ *          calling its handler directly; only bus, CFU and unimplemented instructions fall back to `processInstr()`.
+ *
+ *          Handlers of ALU, branch and jump uops only update the register file and the PC. Scheduling the next
+ *          instruction is left to `CPU::execOneInstr()`, which can therefore run several of them in one event.
+ *
+ *          Vector register operands are stored as `kVRegBase + v`, so one scoreboard covers both register files.
+ */
+struct Uop {
+	using Handler = void (*)(CPU*, const Uop&);
+
+	static constexpr uint8_t kVRegBase = 32;  ///< register number of v0
+
+	Handler handler = nullptr;
+	int32_t imm     = 0;  ///< immediate, or the target address of a branch / jump
+	uint8_t rd      = 0;
+	uint8_t rs1     = 0;
+	uint8_t rs2     = 0;
+	uint8_t op      = UNIMPL;  ///< original `instr_type`
+
+	/** @brief Registers the uop reads or writes, x0 excluded; what the load scoreboard checks */
+	uint64_t regMask() const {
+		return ((uint64_t{1} << rd) | (uint64_t{1} << rs1) | (uint64_t{1} << rs2)) & ~uint64_t{1};
+	}
+};
+static_assert(sizeof(Uop) <= 16, "Uop must stay compact");
 
 /**
  * @class CPU A CPU model integrated with CPU ISA Emulator
@@ -45,26 +83,19 @@ public:
 	void step() override {
 		for (auto s_port : this->s_ports_) {
 			if (s_port.second->isPopValid()) {
-				// CLASS_INFO << "Is pop valid";
-				auto packet = s_port.second->pop();
-				// read req handling
-				if (auto ReadRespPkt = dynamic_cast<XBarMemReadRespPacket*>(packet)) {
-					// CLASS_INFO << "Receive a read resp";
-					this->memReadXBarRespHandler(ReadRespPkt);
-				}
-				// Write req handling
-				else if (auto WriteRespPkt = dynamic_cast<XBarMemWriteRespPacket*>(packet)) {
-					// CLASS_INFO << "Receive a write resp";
-					this->memWriteXBarRespHandler(WriteRespPkt);
-				} else if (auto CFU_packet = dynamic_cast<CFUReqPacket*>(packet)) {
-					this->accept(acalsim::top->getGlobalTick(), *packet);
-				} else {
-					CLASS_ERROR << "Not a valid packet";
-				}
+				// Only CrossBar packets arrive on the bus slave port
+				auto packet = static_cast<XBarPacket*>(s_port.second->pop());
+				this->onArrival(this, packet);
 			}
 		}
 	}
 
+	void receiveBusPacket(XBarPacket* _pkt) override {
+		this->completeTransaction(_pkt);
+		if (!this->busHandlers.dispatch(this, _pkt)) { CLASS_ERROR << "Not a valid packet"; }
+		if (!this->request_queue.empty()) { this->masterPortRetry("bus-m"); }
+	}
+
 	void init() override;
 	void cleanup() override;
 	void masterPortRetry(const std::string& portName) final;
@@ -75,16 +106,29 @@ public:
 	virtual ~CPU() { free(this->imem); }
 
 	/**
-	 * @brief Execute one instruction
+	 * @brief Execute the instruction at the PC
+	 * @details With `SOC.cpu_quantum` above one, keeps executing the following ALU, branch and jump uops in the same
+	 *          event, up to the quantum or the next bus / CFU instruction. The uops are counted as one tick each
+	 *          and the next event is scheduled that many ticks ahead, so the simulated timing does not change.
+	 *
+	 *          An instruction that touches a register still waiting for a load or CFU result, a load issued while
+	 *          the load queue is full, a `fence` with accesses outstanding and `hcf` with results in flight stall the
+	 *          CPU until the next response.
 	 */
 	void execOneInstr();
 
 	/**
-	 * @brief Execute an instruction
+	 * @brief Execute a bus, CFU, vector or HCF instruction; ALU, branch and jump instructions run as uops
 	 * @param _i The instruction to execute
 	 */
 	void processInstr(const instr& _i);
 
+	/**
+	 * @brief Translate the loaded program into the uop array
+	 * @details Must run after the emulator has parsed the program and normalized its labels.
+	 */
+	void predecode();
+
 	/**
 	 * @brief Commits an instruction after execution
 	 * @param _i The instruction to commit
@@ -118,6 +162,7 @@ public:
 	// CFU support
 	void CFURespHandler(CFURespPacket* _pkt);
 	void CFUReq(const instr& _i, uint32_t _rs1, uint32_t _rs2);
+	void CFUReq(const instr& _i, const VReg& _vs1, const VReg& _vs2);
 
 	/**
 	 * @brief Handles response from memory read operations
@@ -131,12 +176,41 @@ public:
 	 */
 	void memWriteRespHandler(XBarMemWriteRespPayload* _pkt);
 
+	/**
+	 * @brief Writes the four beats of a `vl128` burst into its vector register
+	 */
+	void vecLoadRespHandler(XBarMemReadRespPacket* _pkt);
+
+	/**
+	 * @brief Handles the read response of an L1 D-cache line fill
+	 * @param _pkt Burst packet carrying (part of) the missing line
+	 */
+	void dcacheFillHandler(XBarMemReadRespPacket* _pkt);
+
 	/**
 	 * @brief Returns pointer to instruction memory
 	 * @return Pointer to instruction memory array
 	 */
 	inline instr* getIMemPtr() const { return this->imem; }
 
+	/**
+	 * @brief Index of this core in the cluster, passed to the program in a0
+	 */
+	void     setHartID(uint32_t _id) { this->hartID = _id; }
+	uint32_t getHartID() const { return this->hartID; }
+
+	/**
+	 * @brief Address of the first instruction, 0 unless the program is an ELF file with another entry point
+	 */
+	void     setEntryPoint(uint32_t _pc) { this->pc = _pc; }
+	uint32_t getEntryPoint() const { return this->pc; }
+
+	/**
+	 * @brief Text of the program, which the `src` spans of `imem` index; empty for ELF programs
+	 */
+	void             setSource(std::string_view _source) { this->source = _source; }
+	std::string_view getSource() const { return this->source; }
+
 	/**
 	 * @brief Prints the contents of the register file
 	 */
@@ -159,6 +233,25 @@ protected:
 	 */
 	std::string instrToString(instr_type _op) const;
 
+	/**
+	 * @brief Schedules the ExecOneInstrEvent of the next instruction
+	 * @param _delay Ticks from now; more than one when a quantum has run several instructions ahead
+	 */
+	void scheduleNextInstr(acalsim::Tick _delay = 1);
+
+	/**
+	 * @brief Uop handler of the ALU, branch and jump instructions; does not schedule the next instruction
+	 */
+	template <instr_type Op>
+	static void execUop(CPU* _cpu, const Uop& _u);
+
+	/**
+	 * @brief Uop handler of everything else: runs the original `instr` through `processInstr()`
+	 */
+	static void execInstr(CPU* _cpu, const Uop& _u);
+
+	static Uop::Handler uopHandler(instr_type _op);
+
 	/**
 	 * @brief Increments the instruction count
 	 */
@@ -170,13 +263,151 @@ protected:
 	 */
 	inline const int& getInstCount() const { return this->inst_cnt; }
 
+	/**
+	 * @brief Whether the scoreboard lets `_u` issue now
+	 */
+	bool canIssue(const Uop& _u) const;
+
+	/**
+	 * @brief Sends a single-word read to the bus
+	 * @return Whether the load may retire now: true when loads are non-blocking and the result is left to the
+	 *         scoreboard, false when the CPU waits for the response
+	 */
+	bool issueBusLoad(const instr& _i, instr_type _op, uint32_t _addr, operand _a1);
+
+	/**
+	 * @brief Writes back a non-blocking load and wakes the CPU if it stalled on the scoreboard
+	 * @param _rd Scoreboard index of the destination, `Uop::kVRegBase + v` for a vector register
+	 */
+	void retireLoad(uint8_t _rd);
+
+	/**
+	 * @brief Reschedules a CPU that stalled in `execOneInstr()`; it re-checks `canIssue()` next tick
+	 */
+	void resumeIssue();
+
+	/**
+	 * @brief Sends an atomic memory operation to the data memory
+	 * @return Whether the AMO may retire now, as for `issueBusLoad()`
+	 */
+	bool BusAmo(const instr& _i, uint32_t _addr, uint32_t _src);
+
+	/**
+	 * @brief `vl128`: reads 16 bytes from the data memory in one 4-beat burst
+	 * @return Whether the load may retire now, as for `issueBusLoad()`
+	 */
+	bool BusVecLoad(const instr& _i, uint32_t _addr);
+
+	/**
+	 * @brief `vs128`: writes 16 bytes to the data memory in one 4-beat burst
+	 * @return Whether the bus accepted the burst right away; the store retires once it does
+	 */
+	bool BusVecStore(const instr& _i, uint32_t _addr);
+
+	/**
+	 * @brief Store-to-load forwarding from the write buffer
+	 * @param _data The loaded value, sign- or zero-extended, when the youngest overlapping store covers the load
+	 * @return Whether the load was served from the buffer
+	 */
+	bool forwardStore(instr_type _op, uint32_t _addr, uint32_t& _data) const;
+
+	/**
+	 * @brief Sends a request to the CrossBar, or queues it when the bus is busy
+	 * @param _pkt The request packet
+	 * @param _commit_on_accept Retire the current instruction once the bus accepts the packet (CPU stores)
+	 * @param _fill The packet fetches part of the line the L1 D-cache is waiting for
+	 * @return Whether the packet has been accepted right away
+	 */
+	bool sendBusRequest(XBarPacket* _pkt, bool _commit_on_accept, bool _fill = false);
+
+	/**
+	 * @brief Pushes a request onto the bus and records the TID of a line fill, which is only assigned by the push
+	 */
+	bool pushBusRequest(XBarPacket* _pkt, bool _fill);
+
+	/**
+	 * @brief Performs a load/store through the L1 D-cache
+	 * @return Whether the access is done in the current tick
+	 */
+	bool dcacheAccess(const instr& _i, instr_type _op, uint32_t _addr, operand _a1, bool _is_store, uint32_t _data);
+
+	/**
+	 * @brief Applies a load/store to a resident cache line and updates the register file for loads
+	 */
+	void dcacheComplete(instr_type _op, uint32_t _addr, operand _a1, uint32_t _data);
+
+	/**
+	 * @brief Sends a dirty line back to the memory as posted bursts
+	 */
+	void dcacheWriteBack(const instr& _i, const L1DCache::Victim& _victim);
+
+	/**
+	 * @brief Writes back and invalidates every line touched by `[_addr, _addr + _bytes)` ahead of an uncached access
+	 */
+	void dcacheRelease(const instr& _i, uint32_t _addr, size_t _bytes);
+
+	DataMemory* getDataMemory();
+
 private:
-	instr*    imem;         ///< Pointer to instruction memory
-	Emulator* isaEmulator;  ///< Pointer to the ISA emulator
-	uint32_t  rf[32];       ///< Register file with 32 general-purpose registers
-	uint32_t  pc;           ///< Program counter
+	instr*           imem;         ///< Pointer to instruction memory
+	std::vector<Uop> uops;         ///< Predecoded imem, one entry per instruction slot
+	size_t           quantum = 1;  ///< Most ALU / branch uops one ExecOneInstrEvent may run
+	Emulator*        isaEmulator;  ///< Pointer to the ISA emulator
+	std::string_view source;       ///< Program text, owned by the Emulator
+	uint32_t         rf[32];       ///< Register file with 32 general-purpose registers
+	uint32_t         pc;           ///< Program counter
+	uint32_t         hartID = 0;   ///< Core index in the cluster
+
+	// Vector extension
+	std::array<VReg, NUM_VREGS> vrf{};               ///< 128-bit vector registers v0..v7
+	bool                        vectorUsed = false;  ///< The program ran a vector instruction; dump `vrf` too
+
 	// the request queue
-	std::queue<acalsim::SimPacket*> request_queue;
+	struct BusRequest {
+		XBarPacket* pkt;
+		bool        commitOnAccept;    ///< CPU stores retire once the bus accepts them (no write buffer)
+		bool        buffered = false;  ///< Posted store that owns the oldest write buffer entry
+		bool        fill     = false;  ///< L1 D-cache line fill, tracked in `dcacheFillTids` once it is on the bus
+	};
+	std::queue<BusRequest> request_queue;
+
+	// Write buffer: posted stores that are waiting in request_queue for the bus
+	struct BufferedStore {
+		uint32_t addr;
+		uint32_t bytes;
+		uint32_t data;
+	};
+	size_t                    writeBufferDepth = 0;  ///< Posted stores the CPU may run ahead of, 0 to disable
+	std::deque<BufferedStore> writeBuffer;           ///< Oldest first, in the order they sit in request_queue
+	bool                      storeStalled = false;  ///< A store overflowed the buffer and waits to retire
+	instr                     storeStallInstr;
+	acalsim::Tick             writeBufferStallTicks = 0;
+	uint64_t                  storesForwarded       = 0;
+
+	PacketDispatchTable<CPU, XBarPacket> busHandlers;  ///< Handlers for packets popped from the bus slave port
+
+	// L1 data cache (nullptr when disabled)
+	struct DCacheMiss {
+		instr      i;
+		instr_type op;
+		uint32_t   addr;
+		operand    a1;
+		uint32_t   data;
+	};
+	std::unique_ptr<L1DCache> dcache;
+	DCacheMiss                dcacheMiss;      ///< The access waiting for the outstanding line fill
+	std::vector<int>          dcacheFillTids;  ///< Transaction IDs of the in-flight fill bursts
+
+	// Non-blocking loads
+	size_t        loadQueueDepth  = 0;      ///< Loads that may be in flight, 0 for blocking loads
+	size_t        pendingLoads    = 0;      ///< Loads issued to the bus and not yet written back
+	size_t        pendingCfuOps   = 0;      ///< CFU ops issued and not yet written back
+	uint64_t      pendingRegs     = 0;      ///< Scoreboard: bit r is set while a load or CFU op to x<r> is in flight
+	bool          issueStalled    = false;  ///< The CPU waits for a bus or CFU response before issuing again
+	acalsim::Tick stallStart      = 0;
+	acalsim::Tick issueStallTicks = 0;  ///< Ticks spent stalled on the scoreboard, a full load queue or a fence
+	uint64_t      loadsIssued     = 0;
+
 	acalsim::SimPipeRegister*       m_reg;
 	acalsim::SlavePort*             s_port;
 	int                             inst_cnt;  ///< Counter for executed instructions
@@ -5,15 +5,20 @@
 #include <vector>
 
 #include "ACALSim.hh"
+#include "BaseMemory.hh"
 #include "DataMemory.hh"
 #include "MMIOUtil.hh"
 #include "packet/XBarPacket.hh"
 
 class DMAController : public acalsim::CPPSimBase, public MMIOUTIL {
 public:
-	DMAController(std::string _name) : acalsim::CPPSimBase(_name) {
+	DMAController(std::string _name) : acalsim::CPPSimBase(_name), bufferMemory(256 * sizeof(uint32_t)) {
 		LABELED_INFO(this->getName()) << "Constructing...";
 		this->registerSimPort();
+		this->busHandlers.on<&DMAController::handleReadRequest>();
+		this->busHandlers.on<&DMAController::handleWriteRequest>();
+		this->busHandlers.on<&DMAController::handleReadResponse>();
+		this->busHandlers.on<&DMAController::handleWriteCompletion>();
 	};
 
 	virtual ~DMAController() {}
@@ -29,64 +34,31 @@ public:
 
 	void step() override {
 		if (!req_Q.empty() || !resp_Q.empty()) { this->trySendPacket(); }
-		auto rc = acalsim::top->getRecycleContainer();
 		for (auto s_port : this->s_ports_) {
 			if (s_port.second->isPopValid()) {
-				auto packet = s_port.second->pop();
-				// read req handling
-				int delay_lentency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
-				if (auto ReadReqPkt = dynamic_cast<XBarMemReadReqPacket*>(packet)) {
-					assert(ReadReqPkt->getPayloads().size() == ReadReqPkt->getBurstSize() &&
-					       ReadReqPkt->getBurstSize() == 1);
-					auto                          payload = ReadReqPkt->getPayloads();
-					acalsim::LambdaEvent<void()>* event =
-					    new acalsim::LambdaEvent<void()>([this, payload, delay_lentency]() {
-						    this->readMMIO(acalsim::top->getGlobalTick() + delay_lentency, payload[0]);
-					    });
-					this->scheduleEvent(event, acalsim::top->getGlobalTick() + delay_lentency);
-
-					// expect to get the response at
-					acalsim::LambdaEvent<void()>* event_send_req =
-					    new acalsim::LambdaEvent<void()>([this]() { this->trySendPacket(); });
-					this->scheduleEvent(event_send_req, acalsim::top->getGlobalTick() + 1 + delay_lentency);
-					rc->recycle(ReadReqPkt);
-				}
-				// Write req handling
-				else if (auto WriteReq = dynamic_cast<XBarMemWriteReqPacket*>(packet)) {
-					assert(WriteReq->getPayloads().size() == WriteReq->getBurstSize() && WriteReq->getBurstSize() == 1);
-					auto payload = WriteReq->getPayloads();
-					this->writeMMIO(acalsim::top->getGlobalTick(), payload[0]);
-					// expect to get the response at
-					acalsim::LambdaEvent<void()>* event =
-					    new acalsim::LambdaEvent<void()>([this]() { this->trySendPacket(); });
-					this->scheduleEvent(event, acalsim::top->getGlobalTick() + 1 + delay_lentency);
-					rc->recycle(WriteReq);
-				}
-				// read req handling
-				else if (auto ReadRespPkt = dynamic_cast<XBarMemReadRespPacket*>(packet)) {
-					this->handleReadResponse(ReadRespPkt);
-				}
-				// Write req handling
-				else if (auto WriteRespPkt = dynamic_cast<XBarMemWriteRespPacket*>(packet)) {
-					this->handleWriteCompletion(WriteRespPkt);
-				} else {
-					CLASS_ERROR << "UnKnown Packets received";
-				}
-				// this->accept(acalsim::top->getGlobalTick(), *packet);
+				auto packet = static_cast<XBarPacket*>(s_port.second->pop());
+				this->onArrival(this, packet);
 			}
 		}
 	}
 
+	void receiveBusPacket(XBarPacket* _pkt) override {
+		this->completeTransaction(_pkt);
+		if (!this->busHandlers.dispatch(this, _pkt)) { CLASS_ERROR << "UnKnown Packets received"; }
+		if (!this->req_Q.empty()) { this->trySendPacket(); }
+	}
+
 	void trySendPacket() {
 		if (!req_Q.empty()) {
-			if (!m_req->isStalled() && m_req->push(req_Q.front())) {
+			// Held back while the outstanding table is full; a response retries the queue
+			if (this->pushRequest(m_req, static_cast<XBarPacket*>(req_Q.front()))) {
 				req_Q.pop();
 				// CLASS_INFO << "Sending request to other component";
 			}
 		}
 
 		if (!resp_Q.empty()) {
-			if (!m_resp->isStalled() && m_resp->push(resp_Q.front())) {
+			if (this->pushResponse(m_resp, static_cast<XBarPacket*>(resp_Q.front()))) {
 				// CLASS_INFO << "Push a resp to crossBar";
 				resp_Q.pop();
 			}
@@ -99,6 +71,12 @@ public:
 	void writeMMIO(acalsim::Tick _when, XBarMemWriteReqPayload* _memReqPkt);
 	void readMMIO(acalsim::Tick _when, XBarMemReadReqPayload* _memReqPkt);
 
+	/*
+	Request handler (MMIO access from the CPU)
+	*/
+	void handleReadRequest(XBarMemReadReqPacket* pkt);
+	void handleWriteRequest(XBarMemWriteReqPacket* pkt);
+
 	/*
 	Response handler
 	*/
@@ -149,19 +127,19 @@ private:
 	int totalElements;  // total number of bytes to copy (true_width * true_height)
 
 	// Tracking
-	int      wordsToBuffer;
-	int      wordsTransferred;          // Number of words transferred so far
-	int      totalWords;                // Total number of words to transfer
-	int      max_burst_len = 2;         ///< e.g. 2 => burst_size = 2^2 = 4
-	int      bufferIndex;               // Index into bufferMemory
-	int      pendingBusReadResponses;   // Number of outstanding read responses
-	int      pendingBusWriteResponses;  // Number of outstanding write responses
-	uint32_t bufferMemory[256];         ///< Storage for one iteration (just an example size)
+	int        wordsToBuffer;
+	int        wordsTransferred;   // Number of words transferred so far
+	int        totalWords;         // Total number of words to transfer
+	int        max_burst_len = 2;  ///< e.g. 2 => burst_size = 2^2 = 4
+	int        bufferIndex;        // Index into bufferMemory
+	BaseMemory bufferMemory;       ///< Storage for one iteration, 256 words (just an example size)
 	// State: (for conceptual clarity)
 	enum class DmaState { IDLE, READING, WRITING } currentState;
 	// assembled response packets waiting for pipe‑reg
 	std::queue<acalsim::SimPacket*> req_Q;
 	std::queue<acalsim::SimPacket*> resp_Q;
+
+	PacketDispatchTable<DMAController, XBarPacket> busHandlers;
 };
 
 #endif  // SOC_INCLUDE_DMA_HH_
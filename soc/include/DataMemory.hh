@@ -17,14 +17,20 @@
 #ifndef SOC_INCLUDE_DATAMEMORY_HH_
 #define SOC_INCLUDE_DATAMEMORY_HH_
 
+#include <array>
+#include <deque>
+#include <limits>
 #include <queue>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "ACALSim.hh"
 #include "BaseMemory.hh"
+#include "BusArbiter.hh"
 #include "DataStruct.hh"
+#include "LatencyHistogram.hh"
 #include "MMIOUtil.hh"
+#include "MemoryOrder.hh"
 #include "packet/XBarPacket.hh"
 
 /**
@@ -53,67 +59,10 @@ public:
 	 */
 	virtual ~DataMemory() {}
 
-	void init() override { this->m_reg = this->getPipeRegister("bus-m"); };
-	void cleanup() override { ; };
-
-	void step() override {
-		auto rc = acalsim::top->getRecycleContainer();
-		if (!respQ_.empty()) { this->trySendResponse(); }
-
-		for (auto s_port : this->s_ports_) {
-			// CLASS_INFO << s_port.first;
-			int delay_lentency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
-			if (s_port.second->isPopValid()) {
-				// CLASS_INFO << "Is pop valid";
-				int  burst_size = -1;
-				auto packet     = s_port.second->pop();
-				// read req handling
-				if (auto ReadReqPkt = dynamic_cast<XBarMemReadReqPacket*>(packet)) {
-					if (ReadReqPkt->getPayloads().size() != ReadReqPkt->getBurstSize()) {
-						CLASS_ERROR << "Get size : " << ReadReqPkt->getPayloads().size()
-						            << " burst indicates: " << ReadReqPkt->getBurstSize();
-					}
-					assert(ReadReqPkt->getPayloads().size() == ReadReqPkt->getBurstSize());
-					auto payload = ReadReqPkt->getPayloads();
-					burst_size   = payload.size();
-					/* CLASS_INFO << "[DMEM] : pop a read packet : " << ReadReqPkt->getAutoIncTID()
-					           << " with burst size : " << burst_size; */
-					this->pending_[ReadReqPkt->getAutoIncTID()].expected = payload.size();
-					for (int i = 0; i < ReadReqPkt->getBurstSize(); i++) {
-						auto                          payload = ReadReqPkt->getPayloads();
-						acalsim::LambdaEvent<void()>* event =
-						    new acalsim::LambdaEvent<void()>([this, i, payload, delay_lentency]() {
-							    this->memReadReqHandler(acalsim::top->getGlobalTick() + i + delay_lentency, payload[i]);
-						    });
-						this->scheduleEvent(event, acalsim::top->getGlobalTick() + i + delay_lentency);
-					}
-					rc->recycle(ReadReqPkt);
-				}
-				// Write req handling
-				if (auto WriteReq = dynamic_cast<XBarMemWriteReqPacket*>(packet)) {
-					assert(WriteReq->getPayloads().size() == WriteReq->getBurstSize());
-					auto payload = WriteReq->getPayloads();
-					burst_size   = payload.size();
-					/* CLASS_INFO << "[DMEM] : pop a write packet: " << WriteReq->getAutoIncTID() << " with size "
-					           << burst_size; */
-					this->pending_[WriteReq->getAutoIncTID()].expected = payload.size();
-					for (int i = 0; i < WriteReq->getBurstSize(); i++) {
-						auto                          payload = WriteReq->getPayloads();
-						acalsim::LambdaEvent<void()>* event   = new acalsim::LambdaEvent<void()>([this, i, payload,
-                                                                                                delay_lentency]() {
-                            this->memWriteReqHandler(acalsim::top->getGlobalTick() + i + delay_lentency, payload[i]);
-                        });
-						this->scheduleEvent(event, acalsim::top->getGlobalTick() + i + delay_lentency);
-					}
-					rc->recycle(WriteReq);
-				}
-				// expect to get the response at
-				acalsim::LambdaEvent<void()>* event =
-				    new acalsim::LambdaEvent<void()>([this]() { this->trySendResponse(); });
-				this->scheduleEvent(event, acalsim::top->getGlobalTick() + burst_size + 1 + delay_lentency);
-			}
-		}
-	}
+	void init() override;
+	void cleanup() override;
+
+	void step() override;
 
 	void masterPortRetry(const std::string& portName) final;
 
@@ -133,21 +82,122 @@ public:
 	 */
 	void memWriteReqHandler(acalsim::Tick _when, XBarMemWriteReqPayload* _memReqPkt);
 
+	/**
+	 * @brief Retires every completion-queue entry that is due at the current tick
+	 * @details Called by MemCompletionEvent. Re-arms a single event for the next pending entry.
+	 */
+	void serviceCompletions();
+
+	/**
+	 * @brief Select how masters waiting for the memory channel are arbitrated
+	 */
+	void setArbiter(BusArbiter::Policy _policy) { this->arbiter = BusArbiter(_policy); }
+
+	/**
+	 * @brief Size the per-master queues and statistics for the masters attached to the CrossBar
+	 */
+	void setNumMasters(size_t _num_masters);
+
 private:
 	/* ---------- internal helpers ------------ */
-	void trySendResponse();  // pushes one packet if pipe‑reg ready
+	void trySendResponse();  // pushes responses while the pipe‑reg accepts them
+	void scheduleRespond();  // RESPOND two ticks after a burst completes, shared by bursts completing together
+	void acceptRequests();   // pops the slave port while the request queue has room
+	void acceptRequest(XBarPacket* _packet);
+	void grantChannel();     // hands the free channel to the masters picked by the arbiter
+	void startBurst(XBarPacket* _packet, acalsim::Tick _arrival);
+
+	static constexpr int           kMaxBurstBeats = BurstModeBusPacket::kMaxBurstBeats;
+	static constexpr int           kTrackerSlots  = 64;  // bursts in flight inside the memory
+	// Each queued burst holds its beats, plus its arrival GRANT until that is serviced; on top of that at most two
+	// channel GRANTs and two RESPONDs (now + 1, now + 2) are pending
+	static constexpr int           kCompletionCap = kTrackerSlots * (kMaxBurstBeats + 1) + 4;
+	static constexpr acalsim::Tick kNotArmed      = std::numeric_limits<acalsim::Tick>::max();
 
 	struct BurstTracker {
-		int                                   expected;  // burstLen
-		std::vector<XBarMemReadRespPayload*>  rbeats;
-		std::vector<XBarMemWriteRespPayload*> wbeats;
+		bool                                                 busy     = false;
+		int                                                  tid      = -1;
+		int                                                  expected = 0;  // burstLen
+		int                                                  received = 0;
+		MasterID                                             master   = 0;
+		acalsim::Tick                                        issue    = 0;  // tick the master issued the burst
+		std::array<XBarMemReadReqPayload*, kMaxBurstBeats>   rreqs;
+		std::array<XBarMemWriteReqPayload*, kMaxBurstBeats>  wreqs;
+		std::array<XBarMemReadRespPayload*, kMaxBurstBeats>  rbeats;
+		std::array<XBarMemWriteRespPayload*, kMaxBurstBeats> wbeats;
 	};
 
+	// GRANT wakes the arbiter up when the channel becomes free or a request arrives over the NoC
+	enum class CompletionKind : uint8_t { READ_BEAT, WRITE_BEAT, RESPOND, GRANT };
+
+	struct Completion {
+		acalsim::Tick  when;
+		uint64_t       seq;   // keeps entries due at the same tick in issue order
+		CompletionKind kind;
+		int16_t        slot;  // tracker slot, unused for RESPOND
+		int16_t        beat;
+
+		// std heap is a max-heap: the "largest" entry is the earliest one
+		bool operator<(const Completion& _other) const {
+			return this->when != _other.when ? this->when > _other.when : this->seq > _other.seq;
+		}
+	};
+
+	struct MasterQueueStats {
+		uint64_t         requests   = 0;
+		uint64_t         totalDelay = 0;  // ticks spent waiting for the memory channel
+		acalsim::Tick    maxDelay   = 0;
+		LatencyHistogram latency;  // issue -> response assembled, one sample per burst
+	};
+
+	struct PendingRequest {
+		XBarPacket*   pkt;
+		acalsim::Tick arrival;  // tick the request reached the memory (left the slave port, or the NoC)
+	};
+
+	BurstTracker& acquireTracker(int _tid, int _expected);
+	void          releaseTracker(BurstTracker& _tk);
+	BurstTracker& trackerOf(int _tid);
+	// TIDs of different masters share sequence numbers, so spread them by master before probing
+	static int homeSlot(int _tid) {
+		return (BurstModeBusPacket::seqOfTID(_tid) + BurstModeBusPacket::masterOfTID(_tid) * 17u) % kTrackerSlots;
+	}
+	void          pushCompletion(acalsim::Tick _when, CompletionKind _kind, int _slot = -1, int _beat = 0);
+
 	/* ---------- state ------------ */
 
 	acalsim::SimPipeRegister* m_reg;  // from addPRMasterPort("bus-m", ...)
-	// tid -> tracker
-	std::unordered_map<int /*tid*/, BurstTracker> pending_;
+	acalsim::Tick             readLatency  = 0;
+	acalsim::Tick             writeLatency = 0;
+
+	// bandwidth / contention model
+	int           bytesPerCycle   = 0;  // 0: unlimited
+	int           queueDepth      = 0;
+	int           inFlight        = 0;  // bursts holding the channel or a tracker that have not completed yet
+	acalsim::Tick channelFreeTick = 0;  // first tick the memory channel can start a new beat
+
+	// arbitration between masters waiting for the channel, one entry per master (see setNumMasters())
+	BusArbiter                              arbiter{BusArbiter::Policy::AGE};
+	std::vector<std::deque<PendingRequest>> pendingQ;
+	std::vector<uint8_t>                    masterQoS;
+	std::vector<BusArbiter::Request>        heads;  // arbitration scratch, refilled on every grant
+	int                                     numPending  = 0;
+	acalsim::Tick                           grantTick   = kNotArmed;  // pending GRANT completion
+	acalsim::Tick                           respondTick = kNotArmed;  // latest pending RESPOND completion
+
+	std::vector<MasterQueueStats> masterStats;
+
+	// bursts in flight, found by TID through linear probing from homeSlot()
+	std::array<BurstTracker, kTrackerSlots> trackers;
+
+	// tick-ordered completion queue (binary heap over a fixed array)
+	std::array<Completion, kCompletionCap> completions;
+	int                                    numCompletions = 0;
+	uint64_t                               completionSeq  = 0;
+	acalsim::Tick                          armedTick      = kNotArmed;  // earliest pending MemCompletionEvent
+
+	// overlapping beats are performed in grant order whatever their latency
+	MemoryOrder order;
 
 	// assembled response packets waiting for pipe‑reg
 	std::queue<acalsim::SimPacket*> respQ_;
@@ -20,7 +20,8 @@
 #include <cstdint>
 #include <cstdlib>
 
-#define MAX_LABEL_LEN 32
+#define NUM_VREGS  8  // vector registers of the CFU vector extension
+#define VREG_WORDS 4  // 32-bit slices of one 128-bit vector register
 
 typedef enum {
 	UNIMPL = 0,
@@ -70,13 +71,43 @@ typedef enum {
 	S_AMULI8I8S_VV_NQ,
 	S_AMULI8I8S_VV_L,
 	MUL,
+	MULH,
+	MULHSU,
+	MULHU,
+	DIV,
+	DIVU,
+	REM,
+	REMU,
+	AMOSWAP_W,
+	AMOADD_W,
+	AMOAND_W,
+	AMOOR_W,
+	AMOXOR_W,
+	AMOMIN_W,
+	AMOMAX_W,
+	AMOMINU_W,
+	AMOMAXU_W,
+	FENCE,
+	VL128,
+	VS128,
+	VMV_V_X,
+	V_ADDI8I8S_VV,
+	V_ADDI16I16S_VV,
+	V_SUBI8I8S_VV,
+	V_SUBI16I16S_VV,
+	V_PMULI8I16S_VV_L,
+	V_PMULI8I16S_VV_H,
+	V_AMULI8I8S_VV_NQ,
+	V_AMULI8I8S_VV_L,
+	MAC4,
+	RDACC,
 	NOP,
 	HCF
 } instr_type;
 
 typedef struct {
-	char* src;
-	int   offset;
+	uint32_t offset;  // Byte offset of the source line in the program text
+	uint32_t len;
 } source;
 
 typedef enum {
@@ -88,7 +119,7 @@ typedef enum {
 
 typedef struct {
 	operand_type type = OPTYPE_NONE;
-	char         label[MAX_LABEL_LEN];
+	uint32_t     sym;  // SymbolTable ID of the label while type is OPTYPE_LABEL
 	int          reg;
 	uint32_t     imm;
 
@@ -99,14 +130,9 @@ typedef struct {
 	operand    a1;
 	operand    a2;
 	operand    a3;
-	char*      psrc       = NULL;
+	source     src        = {0, 0};  // Source line of the instruction, see Emulator::programSource()
 	int        orig_line  = -1;
 	bool       breakpoint = false;
 } instr;
 
-typedef struct {
-	char label[MAX_LABEL_LEN];
-	int  loc = -1;
-} label_loc;
-
 #endif
@@ -24,11 +24,38 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <deque>
 #include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "ACALSim.hh"
 #include "DataMemory.hh"
 #include "DataStruct.hh"
+#include "MappedFile.hh"
+#include "ProgramImage.hh"
+#include "SymbolTable.hh"
+
+/**
+ * @class LineTokenizer
+ * @brief Splits one line of assembly into tokens in place
+ * @details Works like `strtok()`, but the position is kept in the tokenizer instead of in hidden global state, so any
+ *          number of lines (and Emulator instances) can be tokenized at once.
+ */
+class LineTokenizer {
+public:
+	explicit LineTokenizer(char* _line) : rest(_line) {}
+
+	/**
+	 * @brief Next token delimited by any of `_delims`, NUL-terminated in place
+	 * @return NULL once the line is exhausted
+	 */
+	char* next(const char* _delims);
+
+private:
+	char* rest;  ///< Unconsumed part of the line
+};
 
 class Emulator : virtual public acalsim::HashableType {
 public:
@@ -38,32 +65,91 @@ public:
 	void init();
 
 	// Lab7 Emulator Function Definition
-	uint32_t label_addr(char* _label, label_loc* _labels, int _label_count, int _orig_line);
-	void     append_source(const char* _op, const char* _a1, const char* _a2, const char* _a3, source* _src, instr* _i);
+	uint32_t label_addr(SymbolTable::SymbolID _sym, const SymbolTable& _symbols, int _orig_line);
 	int      parse_reg(char* _tok, int _line, bool _strict = true);
+	int      parse_vreg(char* _tok, int _line);
 	uint32_t parse_imm(char* _tok, int _bits, int _line, bool _strict = true);
 	void     parse_mem(char* _tok, int* _reg, uint32_t* _imm, int _bits, int _line);
-	int      parse_assembler_directive(int _line, char* _ftok, uint8_t* _mem, int _memoff);
-	int      parse_instr(int _line, char* _ftok, instr* _imem, int _memoff, label_loc* _labels, source* _src);
+	int      parse_assembler_directive(int _line, LineTokenizer& _tok, char* _ftok, uint8_t* _mem, int _memoff);
+	int      parse_instr(int _line, LineTokenizer& _tok, char* _ftok, instr* _imem, int _memoff, SymbolTable& _symbols,
+	                     source _src);
 	instr_type parse_instr(char* _tok);
-	int        parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int _ioff, label_loc* _labels, char* _o1,
-	                                    char* _o2, char* _o3, char* _o4, source* _src);
-	int        parse_data_element(int _line, int _size, uint8_t* _mem, int _offset);
+	int        parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int _ioff, SymbolTable& _symbols,
+	                                    char* _o1, char* _o2, char* _o3, char* _o4, source _src);
+	int        parse_data_element(int _line, LineTokenizer& _tok, int _size, uint8_t* _mem, int _offset);
 
 	void     print_syntax_error(int _line, const char* _msg);
 	bool     streq(char* _s, const char* _q);
 	uint32_t signextend(uint32_t _in, int _bits);
 	void     parse(const std::string& _file_path, uint8_t* _mem, instr* _imem);
-	void     parse(const std::string& _file_path, uint8_t* _mem, instr* _imem, int& _memoff, label_loc* _labels,
-	               int& _label_count, source* _src);
+	/**
+	 * @brief Assemble the program `_text` into `_mem` and `_imem`
+	 * @details The text is only read, so it can be a mapped file. The `src` span of every instruction indexes it.
+	 */
+	void     parse(std::string_view _text, uint8_t* _mem, instr* _imem, int& _memoff, SymbolTable& _symbols);
+	/**
+	 * @brief Start a new program image: forget the labels of the previous one and place its `.data` after theirs
+	 */
+	void     beginProgram();
 	void     normalize_labels(instr* _imem);
-	void     normalize_labels(instr* _imem, label_loc* _labels, int _label_count, source* _src);
+	void     normalize_labels(instr* _imem, const SymbolTable& _symbols);
+	/**
+	 * @brief `parse()` and `normalize_labels()` in one step, going through a cached image when `image_cache_dir` is set
+	 * @details The image is found by a hash of the source text, the memory layout and where the program's `.data`
+	 *          starts. On a hit it is memory-mapped and copied into `_mem` and `_imem` without running the assembler;
+	 *          on a miss the program is assembled and its image written for the next run.
+	 */
+	void     assemble(const std::string& _file_path, uint8_t* _mem, instr* _imem);
+
+	/**
+	 * @brief Text of the program assembled last, which the `src` spans of its instructions index
+	 * @details The file stays mapped for the lifetime of the Emulator, so the view can be kept.
+	 */
+	std::string_view programSource() const { return this->sources.empty() ? "" : this->sources.back().text(); }
+
+	/**
+	 * @brief Whether `_file_path` starts with the ELF magic number
+	 */
+	static bool isElf(const std::string& _file_path);
+	/**
+	 * @brief Load a statically linked, little-endian RV32 ELF executable
+	 * @details Every PT_LOAD segment is copied into `_mem` at its virtual address, with its .bss part zeroed. The
+	 *          words of executable segments are also decoded into `_imem`, so they must be linked into
+	 *          [text_offset, data_offset). A segment that overlaps memory an earlier program wrote is rejected, since
+	 *          the cores share the data memory.
+	 * @return The entry point
+	 */
+	uint32_t loadElf(const std::string& _file_path, uint8_t* _mem, instr* _imem);
+	/**
+	 * @brief Decode one RV32IMA machine word at `_pc` into the form the assembly parser produces
+	 * @details CFU ops are decoded from the custom-0 (scalar) and custom-1 (vector) opcodes. ecall and ebreak halt
+	 *          like `hcf`.
+	 * @return false, with `_i->op` set to UNIMPL, if the word is not an instruction the CPU implements
+	 */
+	static bool decode(uint32_t _word, uint32_t _pc, instr* _i);
 
 private:
-	label_loc* labels;
-	int        label_count;
-	int        memoff;
-	source     src;
+	/**
+	 * @brief Record that the program wrote data memory in [_from, _to), for its cached image
+	 */
+	void markWritten(int _from, int _to);
+	/**
+	 * @brief Map `_file_path` as the source of the next program
+	 */
+	const MappedFile& openSource(const std::string& _file_path);
+	uint64_t          imageKey(std::string_view _text) const;
+	bool              restoreImage(const ProgramImage::Contents& _contents, uint8_t* _mem, instr* _imem);
+	bool              saveImage(const std::string& _image_path, uint64_t _key, const uint8_t* _mem,
+	                            const instr* _imem) const;
+
+	SymbolTable                      symbols;  ///< Labels of the program being parsed
+	int                              memoff;
+	int                              dataBase;  ///< Where `.data` starts for the program being parsed
+	int                              dataEnd;   ///< End of the data parsed so far, over every program
+	std::pair<int, int>              textSpan;  ///< Bytes the program wrote below `dataBase`, empty if first >= second
+	std::pair<int, int>              dataSpan;  ///< Bytes the program wrote from `dataBase` on
+	std::vector<std::pair<int, int>> claimed;   ///< Bytes earlier programs wrote, [first, second) each
+	std::deque<MappedFile>           sources;   ///< Every program assembled, kept mapped for `programSource()`
 };
 
 #endif  // SOC_INCLUDE_EMULATOR_HH_
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_L1DCACHE_HH_
+#define SOC_INCLUDE_L1DCACHE_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ACALSim.hh"
+
+class BaseMemory;
+
+/**
+ * @class L1DCache
+ * @brief Set-associative, write-back, write-allocate L1 data cache model
+ * @details The cache only keeps tags, replacement state and the line data. It does not talk to the bus by itself:
+ *          the owning CPU asks for a victim on a miss, sends the write-back / fill bursts and feeds the fill beats
+ *          back with `fillWord()`. Only one miss can be outstanding at a time, matching the blocking CPU.
+ */
+class L1DCache {
+public:
+	enum class ReplacementPolicy { LRU, PLRU };
+
+	/**
+	 * @brief Information about the line that has to leave the cache to make room for a miss
+	 */
+	struct Victim {
+		bool                  writeback = false;  ///< The victim line is dirty and must be written back
+		uint32_t              lineAddr  = 0;      ///< Base address of the victim line
+		std::vector<uint32_t> words;              ///< Line contents, one entry per 32-bit word
+	};
+
+	/**
+	 * @brief Construct a new cache
+	 * @param _name Name used when logging
+	 * @param _sets Number of sets (power of two)
+	 * @param _ways Associativity (power of two when PLRU is used)
+	 * @param _line_size Line size in bytes (power of two, at least 4)
+	 * @param _hit_latency Latency of a hit in ticks
+	 * @param _policy Replacement policy
+	 */
+	L1DCache(const std::string& _name, int _sets, int _ways, int _line_size, acalsim::Tick _hit_latency,
+	         ReplacementPolicy _policy);
+
+	static ReplacementPolicy parsePolicy(const std::string& _policy);
+
+	/**
+	 * @brief Look up an address and update the hit/miss statistics
+	 * @param _addr Accessed byte address
+	 * @param _is_write Whether the access is a store
+	 * @return Whether the access hits
+	 */
+	bool access(uint32_t _addr, bool _is_write);
+
+	/**
+	 * @brief Read `_bytes` bytes from a resident line (the access must hit and must not cross a line)
+	 */
+	uint32_t read(uint32_t _addr, size_t _bytes);
+
+	/**
+	 * @brief Write `_bytes` bytes into a resident line and mark it dirty
+	 */
+	void write(uint32_t _addr, size_t _bytes, uint32_t _data);
+
+	/**
+	 * @brief Reserve a way for the line holding `_addr` and evict its current occupant
+	 * @return The evicted line; `writeback` is set when it has to be written to memory
+	 */
+	Victim beginMiss(uint32_t _addr);
+
+	/**
+	 * @brief Store one fill beat into the line reserved by `beginMiss()`
+	 * @param _word_idx Word index inside the line
+	 * @param _data Word returned by the memory
+	 * @return Whether the whole line has been filled and is now valid
+	 */
+	bool fillWord(int _word_idx, uint32_t _data);
+
+	/**
+	 * @brief Drop the line holding `_addr` so that an uncached access can reach the memory directly
+	 * @return The dropped line; `writeback` is set when it was dirty and has to be written to memory first
+	 */
+	Victim invalidate(uint32_t _addr);
+
+	/**
+	 * @brief Functionally write every dirty line back into `_mem` (used at the end of simulation)
+	 */
+	void flush(BaseMemory* _mem);
+
+	void printStats() const;
+
+	uint32_t      lineBase(uint32_t _addr) const { return _addr & ~(uint32_t)(this->lineSize - 1); }
+	int           getLineSize() const { return this->lineSize; }
+	int           getWordsPerLine() const { return this->lineSize / 4; }
+	acalsim::Tick getHitLatency() const { return this->hitLatency; }
+
+private:
+	int      setIndex(uint32_t _addr) const { return (_addr >> this->offsetBits) & (this->sets - 1); }
+	uint32_t tagOf(uint32_t _addr) const { return _addr >> (this->offsetBits + this->indexBits); }
+	int      lineId(int _set, int _way) const { return _set * this->ways + _way; }
+	int      findWay(uint32_t _addr) const;
+	int      selectVictim(int _set) const;
+	void     touch(int _set, int _way);
+
+	std::string       name;
+	int               sets;
+	int               ways;
+	int               lineSize;
+	int               offsetBits;
+	int               indexBits;
+	acalsim::Tick     hitLatency;
+	ReplacementPolicy policy;
+
+	std::vector<uint32_t> tags;
+	std::vector<uint8_t>  valid;
+	std::vector<uint8_t>  dirty;
+	std::vector<uint8_t>  data;      ///< sets * ways * lineSize bytes
+	std::vector<uint64_t> lruStamp;  ///< last access stamp per line (LRU)
+	std::vector<uint32_t> plruBits;  ///< tree bits per set (PLRU)
+	uint64_t              accessCounter = 0;
+
+	// line reserved by the outstanding miss
+	int fillSet   = -1;
+	int fillWay   = -1;
+	int fillWords = 0;
+
+	// statistics
+	uint64_t readHits    = 0;
+	uint64_t readMisses  = 0;
+	uint64_t writeHits   = 0;
+	uint64_t writeMisses = 0;
+	uint64_t writebacks  = 0;
+};
+
+#endif  // SOC_INCLUDE_L1DCACHE_HH_
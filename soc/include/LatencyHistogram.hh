@@ -0,0 +1,60 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_LATENCYHISTOGRAM_HH_
+#define SOC_INCLUDE_LATENCYHISTOGRAM_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ACALSim.hh"
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size latency histogram for percentile reporting
+ * @details Latencies below 32 ticks get a bucket each. Above that every power of two is split into 16 equal
+ *          buckets, so a percentile is reported at most 1/16 above the exact sample. Memory use does not depend on
+ *          the number of samples; latencies beyond `kMaxTracked` share the last bucket, and the exact maximum is
+ *          kept on the side.
+ */
+class LatencyHistogram {
+public:
+	static constexpr int           kSubBits    = 4;                  ///< log2 of the buckets per power of two
+	static constexpr int           kMaxShift   = 27;                 ///< coarsest bucket width is 2^kMaxShift ticks
+	static constexpr size_t        kNumBuckets = (kMaxShift + 2) << kSubBits;
+	static constexpr acalsim::Tick kMaxTracked = (acalsim::Tick{2} << (kMaxShift + kSubBits)) - 1;
+
+	void record(acalsim::Tick _latency);
+
+	uint64_t      count() const { return this->samples; }
+	acalsim::Tick max() const { return this->maxSample; }
+	/**
+	 * @brief Smallest bucket upper bound that at least `_p` of the samples do not exceed, capped at the maximum
+	 * @param _p Fraction in (0, 1]; returns 0 when no sample has been recorded
+	 */
+	acalsim::Tick percentile(double _p) const;
+
+	static size_t        bucketOf(acalsim::Tick _latency);
+	static acalsim::Tick upperBound(size_t _bucket);
+
+private:
+	std::array<uint64_t, kNumBuckets> buckets{};
+	uint64_t                          samples   = 0;
+	acalsim::Tick                     maxSample = 0;
+};
+
+#endif  // SOC_INCLUDE_LATENCYHISTOGRAM_HH_
@@ -1,88 +1,256 @@
 #ifndef SOC_INCLUDE_MMIOUTIL_HH_
 #define SOC_INCLUDE_MMIOUTIL_HH_
 
+#include <array>
+#include <bit>
+#include <string>
+#include <vector>
+
 #include "ACALSim.hh"
-#include "DataMemory.hh"
+#include "AddressMap.hh"
+#include "DataStruct.hh"
+#include "NoC.hh"
+#include "event/NetArrivalEvent.hh"
 #include "packet/XBarPacket.hh"
 /*  Address map  ---------------------------------------------------------- */
-/*  – 0x0000 – 0x7FFF  : Data‑memory (slave‑idx = 0)                       */
-/*  – 0xF000 – 0xF03F  : DMA‑MMIO  (slave‑idx = 1)                         */
-/* 	– 0x12000 – 0x120F0: SystolicArray‑MMIO  (slave‑idx = 2)			   */
-/* 	– 0x20000 – 0x28000: SystolicArray‑Memory (slave‑idx = 2)			   */
-/*    everything else : map to data‑memory                                 */
+/*  Declared in the "AddressMap" section of configs.json. The default map: */
+/*  – 0xF000 – 0xF03F  : DMA‑MMIO  (slave‑idx = 1)                         */
+/*  – 0x12000 – 0x120F0: SystolicArray‑MMIO  (slave‑idx = 2)               */
+/*  – 0x20000 – 0x28000: SystolicArray‑Memory (slave‑idx = 2)              */
+/*    everything else : map to data‑memory (slave‑idx = 0)                 */
+
+/**
+ * @class MasterRegistry
+ * @brief Maps the compact `MasterID` carried in bus payloads back to a device name
+ * @details Masters are registered once while the SoC is built; the returned ID is the request port index on the
+ *          CrossBar. Names are only looked up for logging.
+ */
+class MasterRegistry {
+public:
+	static MasterID registerMaster(const std::string& _name) {
+		LABELED_ASSERT(names().size() < BurstModeBusPacket::kMaxTidMasters, "MasterRegistry: too many bus masters");
+		names().push_back(_name);
+		return static_cast<MasterID>(names().size() - 1);
+	}
+
+	static const std::string& nameOf(MasterID _id) {
+		static const std::string unknown = "unknown";
+		return _id < names().size() ? names()[_id] : unknown;
+	}
+
+private:
+	static std::vector<std::string>& names() {
+		static std::vector<std::string> registered;
+		return registered;
+	}
+};
+
 class MMIOUTIL {
-	/* --- helpers ------------------------------------------------------- */
-	constexpr static uint32_t DMA_MMIO_BASE  = 0xF000;
-	constexpr static uint32_t DMA_MMIO_END   = 0xF03F;
-	constexpr static uint32_t SA_MMIO_BASE   = 0x12000;
-	constexpr static uint32_t SA_MMIO_END    = 0x120F0;
-	constexpr static uint32_t SA_MEMORY_BASE = 0x20000;
-	constexpr static uint32_t SA_MEMORY_END  = 0x28000;
-
-	static size_t getIndex(const std::string& name) {
-		if (name == "cpu" || name == "dm") return 0;  // cpu, dm (first in index)
-		if (name == "dma") return 1;                  // dma -> Req[1]
-		if (name == "sa") return 2;
-		return 0;  // default / unknown
-	}
-
-	static size_t slaveIndex(uint32_t addr) {
-		if (addr >= DMA_MMIO_BASE && addr <= DMA_MMIO_END) {
-			return 1;
-		} else if ((addr >= SA_MMIO_BASE && addr <= SA_MMIO_END) || (addr >= SA_MEMORY_BASE && addr <= SA_MEMORY_END)) {
-			return 2;
-		} else {
-			return 0;
-		}
+public:
+	virtual ~MMIOUTIL() = default;
+
+	/* --- bus identity, assigned by the SoC when it wires the CrossBar ---- */
+	void     setMasterID(MasterID _id) { this->masterID = _id; }
+	MasterID getMasterID() const { return this->masterID; }
+	void     setSlaveID(size_t _id) { this->slaveID = _id; }
+	size_t   getSlaveID() const { return this->slaveID; }
+	void     setAddressMap(const AddressMap* _map) { this->addressMap = _map; }
+	void     setMemorySlave(size_t _id) { this->memSlave = _id; }
+	void     setQoS(uint8_t _qos) { this->qos = _qos; }
+	uint8_t  getQoS() const { return this->qos; }
+	void     setNoC(NoCModel* _noc) { this->noc = _noc; }
+
+	/** @brief Transactions this master has issued and not yet seen a response for */
+	size_t getOutstanding() const { return this->numOutstanding; }
+	/** @brief Outstanding transactions of one request kind (MEM_READ_REQ or MEM_WRITE_REQ) */
+	size_t getOutstanding(PacketKind _kind) const { return this->outstandingByKind[static_cast<size_t>(_kind)]; }
+
+	/** @brief Handle a packet popped from `bus-s` once it has crossed the network */
+	virtual void receiveBusPacket(XBarPacket* _pkt) {
+		ERROR << "MMIOUTIL: packet delivered to a device that does not take packets from bus-s";
 	}
 
 protected:
+	MasterID          masterID   = 0;        ///< request port index of this device (masters only)
+	size_t            slaveID    = 0;        ///< response port index of this device (slaves only)
+	const AddressMap* addressMap = nullptr;  ///< shared SoC address map (masters only)
+	size_t            memSlave   = 0;        ///< response port index of the data memory (masters only)
+	uint8_t           qos        = 0;        ///< arbitration priority of this master's requests
+	NoCModel*         noc        = nullptr;  ///< shared network timing model, disabled on a plain CrossBar
+
+	/* --- outstanding transactions (masters only) ------------------------ */
+	static constexpr size_t kMaxOutstanding = 64;  ///< transactions a master may have in flight
+	static constexpr int    kSlotBits       = 6;   ///< low TID sequence bits that name the outstanding slot
+
+	struct Outstanding {
+		int           tid   = -1;  ///< -1 when the slot is free
+		PacketKind    kind  = PacketKind::NUM_KINDS;
+		acalsim::Tick issue = 0;
+	};
+
+	static constexpr size_t kNumKinds = static_cast<size_t>(PacketKind::NUM_KINDS);
+	static_assert(kMaxOutstanding == 64, "MMIOUTIL: the slot bitmap is one 64-bit word");
+	static_assert(kMaxOutstanding == size_t{1} << kSlotBits, "MMIOUTIL: every slot needs its own TID bits");
+
+	uint32_t                                 tidSeq = 0;           ///< transactions this master has put on the bus
+	std::array<Outstanding, kMaxOutstanding> outstanding;          ///< slots handed out from `busySlots`
+	uint64_t                                 busySlots = 0;        ///< bit i set while `outstanding[i]` is in use
+	std::array<uint32_t, kNumKinds>          outstandingByKind{};  ///< outstanding count per request kind
+	size_t                                   numOutstanding = 0;
+
+	size_t slaveIndex(uint32_t addr) const {
+		LABELED_ASSERT(this->addressMap, "MMIOUTIL: the address map has not been attached");
+		return this->addressMap->decode(addr);
+	}
+
+	/** @brief `addr` is served by the data memory rather than by a device register file */
+	bool isDataMemory(uint32_t addr) const { return this->slaveIndex(addr) == this->memSlave; }
+
+	/**
+	 * @brief Pass a packet popped from `bus-s` to `receiveBusPacket()` once it has crossed the network
+	 * @details Immediate on a plain CrossBar; on a mesh or ring a recycled NetArrivalEvent delivers it on the
+	 *          packet's arrival tick.
+	 */
+	template <typename Owner>
+	void onArrival(Owner* _owner, XBarPacket* _pkt) {
+		if (_pkt->getNetArrival() <= acalsim::top->getGlobalTick()) {
+			this->receiveBusPacket(_pkt);
+			return;
+		}
+		auto rc = acalsim::top->getRecycleContainer();
+		_owner->scheduleEvent(rc->acquire<NetArrivalEvent>(&NetArrivalEvent::renew, this, _pkt), _pkt->getNetArrival());
+	}
+
+	/** @brief Stamp a request and every beat of it with its transaction ID */
+	static void stampTID(XBarPacket* _pkt, int _tid) {
+		_pkt->setTID(_tid);
+		switch (_pkt->getKind()) {
+			case PacketKind::MEM_READ_REQ:
+				for (auto payload : static_cast<XBarMemReadReqPacket*>(_pkt)->getPayloads()) { payload->setTid(_tid); }
+				break;
+			case PacketKind::MEM_WRITE_REQ:
+				for (auto payload : static_cast<XBarMemWriteReqPacket*>(_pkt)->getPayloads()) { payload->setTid(_tid); }
+				break;
+			default: break;
+		}
+	}
+
+	/** @brief A free outstanding slot is left, so one more request may go on the bus */
+	bool canIssueTransaction() const { return this->busySlots != ~uint64_t{0}; }
+
+	/**
+	 * @brief Push a response onto the slave's response port
+	 * @return false when the port is stalled or refused the packet; the caller keeps it queued
+	 */
+	bool pushResponse(acalsim::SimPipeRegister* _port, XBarPacket* _pkt) {
+		if (_port->isStalled() || !_port->push(_pkt)) return false;
+		this->routeOnNoC(_pkt, false, this->slaveID, _pkt->getDstIdx());
+		return true;
+	}
+
+	/**
+	 * @brief Push a request onto the master port, give it a TID and record it as outstanding
+	 * @details The TID is only known once this returns true. Its low `kSlotBits` sequence bits are the outstanding
+	 *          slot, so a response finds its slot without a lookup; the bits above count this master's transactions.
+	 * @return false when the slot table is full or the port refused the packet; the caller keeps the request
+	 *         queued and retries once a response retires a slot or the port frees up
+	 */
+	bool pushRequest(acalsim::SimPipeRegister* _port, XBarPacket* _pkt) {
+		if (!this->canIssueTransaction() || _port->isStalled()) return false;
+		size_t   idx = std::countr_one(this->busySlots);
+		uint32_t seq = (this->tidSeq << kSlotBits | static_cast<uint32_t>(idx)) & BurstModeBusPacket::kTidSeqMask;
+		stampTID(_pkt, BurstModeBusPacket::makeTID(this->masterID, seq));
+		if (!_port->push(_pkt)) return false;
+		this->routeOnNoC(_pkt, true, this->masterID, _pkt->getDstIdx());
+		this->tidSeq++;
+		Outstanding& slot = this->outstanding[idx];
+		slot              = {_pkt->getAutoIncTID(), _pkt->getKind(), acalsim::top->getGlobalTick()};
+		this->busySlots |= uint64_t{1} << idx;
+		this->outstandingByKind[static_cast<size_t>(slot.kind)]++;
+		this->numOutstanding++;
+		return true;
+	}
+
+	/**
+	 * @brief Retire the transaction a response belongs to
+	 * @details Slaves may answer in any order, so responses are matched by TID rather than by arrival order.
+	 *          Requests popped from `bus-s` pass through untouched.
+	 */
+	void completeTransaction(const XBarPacket* _pkt) {
+		PacketKind kind = _pkt->getKind();
+		if (kind != PacketKind::MEM_READ_RESP && kind != PacketKind::MEM_WRITE_RESP) return;
+		int          tid  = _pkt->getAutoIncTID();
+		size_t       idx  = BurstModeBusPacket::seqOfTID(tid) & (kMaxOutstanding - 1);
+		Outstanding& slot = this->outstanding[idx];
+		if (slot.tid != tid) {
+			ERROR << "MMIOUTIL: response for unknown transaction " << tid << " received by master " << this->masterID;
+			return;
+		}
+		this->outstandingByKind[static_cast<size_t>(slot.kind)]--;
+		this->numOutstanding--;
+		this->busySlots &= ~(uint64_t{1} << idx);
+		slot.tid = -1;
+	}
+
+	/**
+	 * @brief Reserve the NoC path of a packet the bus has just accepted
+	 * @details Routed at push time rather than when the packet is built, so a packet that waits in a device queue
+	 *          does not hold links it is not using yet. Writes and read responses carry one 32-bit word per beat
+	 *          after the header flit.
+	 * @param _src, _dst CrossBar port indices: master to slave for requests, slave to master for responses
+	 */
+	void routeOnNoC(XBarPacket* _pkt, bool _request, size_t _src, size_t _dst) {
+		if (!this->noc || !this->noc->enabled()) return;
+		PacketKind kind     = _pkt->getKind();
+		bool       has_data = kind == PacketKind::MEM_WRITE_REQ || kind == PacketKind::MEM_READ_RESP;
+		size_t     data     = has_data ? _pkt->getBurstSize() : 0;
+		size_t     src      = _request ? this->noc->masterNode(_src) : this->noc->slaveNode(_src);
+		size_t     dst      = _request ? this->noc->slaveNode(_dst) : this->noc->masterNode(_dst);
+		_pkt->setNetArrival(
+		    this->noc->traverse(src, dst, NoCModel::kHeaderBytes + data * 4, acalsim::top->getGlobalTick()));
+	}
+
 	/* ----------------------------- READ -------------------------------- */
 	XBarMemReadReqPacket* Construct_MemReadpkt_non_burst(const instr& _i, instr_type _op, uint32_t _addr, operand _a1,
-	                                                     const std::string& caller, int burst /* log2(#beats) */ = 0) {
+	                                                     int burst /* log2(#beats) */ = 0) {
 		/* assemble burst payloads */
-		auto                                rc = acalsim::top->getRecycleContainer();
-		std::vector<XBarMemReadReqPayload*> payloads;
-		XBarMemReadReqPayload*              mem_req_packet =
+		auto                   rc = acalsim::top->getRecycleContainer();
+		XBarMemReadReqPayload* mem_req_packet =
 		    rc->acquire<XBarMemReadReqPayload>(&XBarMemReadReqPayload::renew, _i, _op, _addr, _a1);
-		mem_req_packet->setCaller(caller);
-		payloads.push_back(mem_req_packet);
-		size_t                src      = getIndex(caller);
-		size_t                dst      = slaveIndex(_addr);
-		bool                  renew_id = true;
+		mem_req_packet->setMaster(this->masterID);
+		XBarMemReadReqPayload* payloads[] = {mem_req_packet};
+
+		size_t                src = this->masterID;
+		size_t                dst = slaveIndex(_addr);
 		XBarMemReadReqPacket* pkt =
-		    rc->acquire<XBarMemReadReqPacket>(&XBarMemReadReqPacket::renew, burst, payloads, src, dst, renew_id);
-		pkt->getPayloads()[0]->setTid(pkt->getAutoIncTID());
+		    rc->acquire<XBarMemReadReqPacket>(&XBarMemReadReqPacket::renew, burst, std::span(payloads), src, dst);
+		pkt->setIssue(this->qos, acalsim::top->getGlobalTick());
 
 		return pkt;
 	}
 
 	/* ----------------------------- WRITE ------------------------------- */
 	XBarMemWriteReqPacket* Construct_MemWritepkt_non_burst(const instr& _i, instr_type _op, uint32_t _addr,
-	                                                       uint32_t _data, const std::string& caller,
-	                                                       int burst /* log2(#beats) */ = 0) {
-		auto                                 rc = acalsim::top->getRecycleContainer();
-		std::vector<XBarMemWriteReqPayload*> payloads;
+	                                                       uint32_t _data, int burst /* log2(#beats) */ = 0) {
+		auto rc = acalsim::top->getRecycleContainer();
 
 		XBarMemWriteReqPayload* mem_req_packet =
 		    rc->acquire<XBarMemWriteReqPayload>(&XBarMemWriteReqPayload::renew, _i, _op, _addr, _data);
-		mem_req_packet->setCaller(caller);
-		payloads.push_back(mem_req_packet);
+		mem_req_packet->setMaster(this->masterID);
+		XBarMemWriteReqPayload* payloads[] = {mem_req_packet};
 
-		size_t                 src      = getIndex(caller);
-		size_t                 dst      = slaveIndex(_addr);
-		bool                   renew_id = true;
+		size_t                 src = this->masterID;
+		size_t                 dst = slaveIndex(_addr);
 		XBarMemWriteReqPacket* pkt =
-		    rc->acquire<XBarMemWriteReqPacket>(&XBarMemWriteReqPacket::renew, burst, payloads, src, dst, renew_id);
-		pkt->getPayloads()[0]->setTid(pkt->getAutoIncTID());
+		    rc->acquire<XBarMemWriteReqPacket>(&XBarMemWriteReqPacket::renew, burst, std::span(payloads), src, dst);
+		pkt->setIssue(this->qos, acalsim::top->getGlobalTick());
 
 		return pkt;
 	}
 
-	XBarMemReadReqPacket* Construct_MemReadpkt_burst(std::string _src, std::vector<XBarMemReadReqPayload*>& payloads) {
+	XBarMemReadReqPacket* Construct_MemReadpkt_burst(std::vector<XBarMemReadReqPayload*>& payloads) {
 		/* assemble burst payloads */
 		auto rc           = acalsim::top->getRecycleContainer();
-		bool renew_id     = true;
 		int  payload_size = payloads.size();
 		int  burst        = -1;
 		switch (payload_size) {
@@ -91,20 +259,18 @@ protected:
 			case 1: burst = 0; break;
 			default: burst = -1; break;
 		}
-		for (auto payload : payloads) { payload->setCaller(_src); }
-		size_t                src = getIndex(_src);
+		for (auto payload : payloads) { payload->setMaster(this->masterID); }
+		size_t                src = this->masterID;
 		size_t                dst = slaveIndex(payloads[0]->getAddr());
 		XBarMemReadReqPacket* pkt =
-		    rc->acquire<XBarMemReadReqPacket>(&XBarMemReadReqPacket::renew, burst, payloads, src, dst, renew_id);
-		for (auto payload : pkt->getPayloads()) { payload->setTid(pkt->getAutoIncTID()); }
+		    rc->acquire<XBarMemReadReqPacket>(&XBarMemReadReqPacket::renew, burst, payloads, src, dst);
+		pkt->setIssue(this->qos, acalsim::top->getGlobalTick());
 		return pkt;
 	}
 
-	XBarMemWriteReqPacket* Construct_MemWritepkt_burst(std::string                           _src,
-	                                                   std::vector<XBarMemWriteReqPayload*>& payloads) {
+	XBarMemWriteReqPacket* Construct_MemWritepkt_burst(std::vector<XBarMemWriteReqPayload*>& payloads) {
 		auto rc           = acalsim::top->getRecycleContainer();
 		int  payload_size = payloads.size();
-		bool renew_id     = true;
 		int  burst        = -1;
 		switch (payload_size) {
 			case 4: burst = 2; break;
@@ -112,37 +278,40 @@ protected:
 			case 1: burst = 0; break;
 			default: burst = -1; break;
 		}
-		for (auto payload : payloads) { payload->setCaller(_src); }
+		for (auto payload : payloads) { payload->setMaster(this->masterID); }
 
-		size_t                 src = getIndex(_src);
+		size_t                 src = this->masterID;
 		size_t                 dst = slaveIndex(payloads[0]->getAddr());
 		XBarMemWriteReqPacket* pkt =
-		    rc->acquire<XBarMemWriteReqPacket>(&XBarMemWriteReqPacket::renew, burst, payloads, src, dst, renew_id);
-		for (auto payload : pkt->getPayloads()) { payload->setTid(pkt->getAutoIncTID()); }
+		    rc->acquire<XBarMemWriteReqPacket>(&XBarMemWriteReqPacket::renew, burst, payloads, src, dst);
+		pkt->setIssue(this->qos, acalsim::top->getGlobalTick());
 		return pkt;
 	}
 
 	/* read‑response */
-	XBarMemReadRespPacket* Construct_MemReadRespPkt(const std::vector<XBarMemReadRespPayload*>& beats,
-	                                                const std::string& src, const std::string& dst /*DataMem*/) {
+	XBarMemReadRespPacket* Construct_MemReadRespPkt(std::span<XBarMemReadRespPayload* const> beats,
+	                                                MasterID                                 dst) {
 		int    burstMode = (beats.size() == 1) ? 0 : static_cast<int>(std::ceil(std::log2(beats.size())));
 		auto   rc        = acalsim::top->getRecycleContainer();
-		size_t dst_idx   = getIndex(dst);
-		size_t src_idx   = getIndex(src);
+		size_t dst_idx   = dst;
+		size_t src_idx   = this->slaveID;
 
-		return rc->acquire<XBarMemReadRespPacket>(&XBarMemReadRespPacket::renew, burstMode, beats, src_idx, dst_idx,
-		                                          false);
+		auto pkt =
+		    rc->acquire<XBarMemReadRespPacket>(&XBarMemReadRespPacket::renew, burstMode, beats, src_idx, dst_idx);
+		return pkt;
 	}
 
 	/* write‑response */
-	XBarMemWriteRespPacket* Construct_MemWriteRespPkt(const std::vector<XBarMemWriteRespPayload*>& beats,
-	                                                  const std::string& src, const std::string& dst) {
+	XBarMemWriteRespPacket* Construct_MemWriteRespPkt(std::span<XBarMemWriteRespPayload* const> beats,
+	                                                  MasterID                                  dst) {
 		int    burstMode = (beats.size() == 1) ? 0 : static_cast<int>(std::ceil(std::log2(beats.size())));
 		auto   rc        = acalsim::top->getRecycleContainer();
-		size_t dst_idx   = getIndex(dst);
-		size_t src_idx   = getIndex(src);
-		return rc->acquire<XBarMemWriteRespPacket>(&XBarMemWriteRespPacket::renew, burstMode, beats, src_idx, dst_idx,
-		                                           false);
+		size_t dst_idx   = dst;
+		size_t src_idx   = this->slaveID;
+
+		auto pkt =
+		    rc->acquire<XBarMemWriteRespPacket>(&XBarMemWriteRespPacket::renew, burstMode, beats, src_idx, dst_idx);
+		return pkt;
 	}
 };
 
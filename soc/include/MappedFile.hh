@@ -0,0 +1,53 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_MAPPEDFILE_HH_
+#define SOC_INCLUDE_MAPPEDFILE_HH_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file
+ * @details The bytes stay valid, at a fixed address, until the file is closed or the object destroyed, so views into
+ *          them can be kept instead of copies. An empty file opens successfully with an empty view.
+ */
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile() { this->close(); }
+	MappedFile(const MappedFile&)            = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * @brief Map `_path`, closing any file mapped before
+	 * @return false if the file cannot be opened or mapped
+	 */
+	bool open(const std::string& _path);
+	void close();
+
+	const char*      data() const { return static_cast<const char*>(this->base); }
+	size_t           size() const { return this->length; }
+	std::string_view text() const { return {this->data(), this->length}; }
+
+private:
+	void*  base   = nullptr;
+	size_t length = 0;
+};
+
+#endif  // SOC_INCLUDE_MAPPEDFILE_HH_
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_MEMORYORDER_HH_
+#define SOC_INCLUDE_MEMORYORDER_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ACALSim.hh"
+
+/**
+ * @class MemoryOrder
+ * @brief Keeps overlapping beats of the memory channel performed in the order they were granted
+ * @details Reads and writes have their own access latency, so a store granted after a load to the same word would
+ *          be performed first when writes are faster, and a load granted after a store would overtake it when reads
+ *          are faster. The owner calls `schedule()` for every beat in grant order; a beat is delayed until every
+ *          earlier-granted beat that overlaps it, with at least one of the two writing, has been performed. Beats
+ *          to other addresses keep their own latency.
+ */
+class MemoryOrder {
+public:
+	static constexpr size_t kMaxBeats = 512;  ///< beats due at or after the current tick
+
+	/**
+	 * @brief Tick a beat granted now is performed at
+	 * @param _now Current tick; beats due before it have been performed and are forgotten
+	 * @param _ready Tick the beat would be performed at with its own latency
+	 * @param _addr First byte accessed
+	 * @param _bytes Number of bytes accessed
+	 * @param _write Whether the beat modifies memory (stores and AMOs)
+	 * @return `_ready`, or the tick of the last conflicting beat if that is later. Beats due at the same tick are
+	 *         performed in grant order by the owner.
+	 */
+	acalsim::Tick schedule(acalsim::Tick _now, acalsim::Tick _ready, uint32_t _addr, uint32_t _bytes, bool _write);
+
+private:
+	struct Beat {
+		acalsim::Tick when;
+		uint64_t      begin;
+		uint64_t      end;
+		bool          write;
+	};
+
+	std::array<Beat, kMaxBeats> beats;
+	size_t                      numBeats = 0;
+};
+
+#endif  // SOC_INCLUDE_MEMORYORDER_HH_
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_NOC_HH_
+#define SOC_INCLUDE_NOC_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ACALSim.hh"
+
+/**
+ * @class NoCModel
+ * @brief Timing model of a mesh or ring network-on-chip placed over the CrossBar
+ * @details The CrossBar still moves every packet between the `bus-m` / `bus-s` ports, so devices attach unchanged.
+ *          When the interconnect is a mesh or a ring, the sender stamps each packet with the tick its tail flit
+ *          reaches the destination router (`traverse()`) and the receiver handles it no earlier than that tick.
+ *
+ *          Each device sits on one router. A packet is split into `ceil(bytes / link_width)` flits and crosses the
+ *          routers on its path in wormhole fashion: every router adds `router_latency`, every link is held for one
+ *          tick per flit, and a packet that finds its output link still held by an earlier packet waits for it.
+ *          Meshes use dimension-ordered XY routing; rings take the shorter direction, clockwise on a tie.
+ */
+class NoCModel {
+public:
+	enum class Kind { CROSSBAR, MESH, RING };
+
+	/** @brief Bytes of the address / command flit every packet carries */
+	static constexpr size_t kHeaderBytes = 4;
+
+	static Kind        parseKind(const std::string& _kind);
+	static const char* kindName(Kind _kind);
+
+	/**
+	 * @brief Size the network and place the bus ports on its routers
+	 * @param _kind Interconnect type; CROSSBAR disables the model
+	 * @param _cols, _rows Router grid; a ring links the `_cols * _rows` routers in one loop
+	 * @param _router_latency Pipeline delay of one router, in ticks
+	 * @param _link_width Bytes a link moves per tick (flit size)
+	 * @param _master_nodes Router of each master, indexed by `MasterID`
+	 * @param _slave_nodes Router of each slave, indexed by slave index
+	 */
+	void build(Kind _kind, size_t _cols, size_t _rows, acalsim::Tick _router_latency, size_t _link_width,
+	           std::vector<size_t> _master_nodes, std::vector<size_t> _slave_nodes);
+
+	bool enabled() const { return this->kind != Kind::CROSSBAR; }
+	Kind getKind() const { return this->kind; }
+
+	size_t masterNode(size_t _master) const { return this->masterNodes[_master]; }
+	size_t slaveNode(size_t _slave) const { return this->slaveNodes[_slave]; }
+
+	/**
+	 * @brief Reserve the links from `_src` to `_dst` for a packet injected at `_inject`
+	 * @return Tick the tail flit arrives at the destination router
+	 */
+	acalsim::Tick traverse(size_t _src, size_t _dst, size_t _bytes, acalsim::Tick _inject);
+
+	/**
+	 * @brief Print hop, latency and per-link utilization statistics
+	 */
+	void report() const;
+
+private:
+	/** @brief Output ports of a router; a ring only uses EAST (clockwise) and WEST (counter-clockwise) */
+	enum Dir : size_t { EAST = 0, WEST, NORTH, SOUTH, NUM_DIRS };
+
+	/** @brief Output port taken at `_at` towards `_dst`, or NUM_DIRS once the packet has arrived */
+	Dir    route(size_t _at, size_t _dst) const;
+	size_t neighbor(size_t _at, Dir _dir) const;
+
+	Kind          kind          = Kind::CROSSBAR;
+	size_t        cols          = 1;
+	size_t        rows          = 1;
+	acalsim::Tick routerLatency = 1;
+	size_t        linkWidth     = 4;
+
+	std::vector<size_t>        masterNodes;
+	std::vector<size_t>        slaveNodes;
+	std::vector<acalsim::Tick> linkFree;   ///< tick each output link is released, indexed node * NUM_DIRS + dir
+	std::vector<uint64_t>      linkFlits;  ///< flits carried by each output link
+
+	uint64_t      packets       = 0;
+	uint64_t      totalHops     = 0;
+	acalsim::Tick totalLatency  = 0;
+	acalsim::Tick totalStall    = 0;  ///< ticks spent waiting for busy links
+	acalsim::Tick maxLatency    = 0;
+	acalsim::Tick lastDelivered = 0;
+};
+
+#endif  // SOC_INCLUDE_NOC_HH_
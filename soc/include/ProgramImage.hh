@@ -0,0 +1,121 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_PROGRAMIMAGE_HH_
+#define SOC_INCLUDE_PROGRAMIMAGE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "DataStruct.hh"
+#include "MappedFile.hh"
+
+/**
+ * @class ProgramImage
+ * @brief Versioned binary image of an assembled program, so later runs can skip the assembler
+ * @details An image holds everything `Emulator::parse()` and `normalize_labels()` leave behind: the instruction
+ *          memory, the bytes written into data memory and the symbol table. It is keyed by a hash of the source file
+ *          and of every parameter the assembled output depends on, so the source spans of its instructions still
+ *          index that file.
+ *
+ *          `map()` memory-maps an image read-only and exposes its sections as views into the mapping, so loading
+ *          is a handful of memcpy calls. `write()` goes through a temporary file and `rename()`, so concurrent runs
+ *          of a parameter sweep never see a partially written image.
+ */
+class ProgramImage {
+public:
+	/** @brief Bump whenever the file layout, `instr` or `instr_type` changes */
+	static constexpr uint32_t kVersion = 2;
+
+	/** @brief Bytes written into data memory at `addr` */
+	struct Segment {
+		uint32_t                 addr;
+		std::span<const uint8_t> bytes;
+	};
+
+	/** @brief Label name and address, -1 if it was referenced but never defined */
+	using Symbol = std::pair<std::string_view, int64_t>;
+
+	/** @brief The sections of an image; every view points into the caller's buffers or into the mapping */
+	struct Contents {
+		std::span<const instr> imem;         ///< One entry per word below data_offset
+		std::vector<Segment>   segments;     ///< Data memory written by the program
+		std::vector<Symbol>    symbols;      ///< Labels in SymbolTable ID order
+		int32_t                memoff  = 0;  ///< Location counter after parsing
+		int32_t                dataEnd = 0;  ///< End of the data parsed so far
+	};
+
+	/**
+	 * @brief Word-at-a-time FNV-1a hash of `_len` bytes, chained through `_seed`
+	 */
+	static uint64_t hash(const void* _data, size_t _len, uint64_t _seed = 0xcbf29ce484222325ull);
+
+	/**
+	 * @brief Map the image at `_path`
+	 * @return false if it is missing, truncated, of another version or built for another key
+	 */
+	bool map(const std::string& _path, uint64_t _key);
+
+	/**
+	 * @brief Atomically write `_contents` as the image of `_key` to `_path`
+	 * @return false if the file could not be written
+	 */
+	static bool write(const std::string& _path, uint64_t _key, const Contents& _contents);
+
+	/** @brief Sections of the mapped image, valid until it is unmapped */
+	const Contents& contents() const { return this->view; }
+
+	void unmap();
+
+private:
+	/** @brief Fixed-size header at offset 0; every section after it starts 8-byte aligned */
+	struct Header {
+		char     magic[8];
+		uint32_t version;
+		uint32_t instrSize;  ///< sizeof(instr) of the build that wrote the image
+		uint64_t key;
+		uint64_t fileSize;
+		uint32_t numInstrs;
+		uint32_t numSegments;
+		uint32_t numSymbols;
+		uint32_t nameBytes;
+		int32_t  memoff;
+		int32_t  dataEnd;
+	};
+
+	/** @brief Per-segment and per-symbol records, followed by the segment bytes and the names they refer to */
+	struct SegmentEntry {
+		uint32_t addr;
+		uint32_t size;
+	};
+	struct SymbolEntry {
+		int64_t  loc;
+		uint32_t nameOffset;
+		uint32_t nameLen;
+	};
+
+	static constexpr char kMagic[8] = {'A', 'C', 'A', 'L', 'I', 'M', 'G', '\0'};
+
+	MappedFile file;
+	Contents   view;
+};
+
+#endif  // SOC_INCLUDE_PROGRAMIMAGE_HH_
@@ -24,7 +24,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "ACALSim.hh"
 #include "CFU.hh"
@@ -33,6 +36,7 @@
 #include "DataMemory.hh"
 #include "DataStruct.hh"
 #include "Emulator.hh"
+#include "NoC.hh"
 #include "SystemConfig.hh"
 #include "SystolicArray.hh"
 
@@ -61,12 +65,22 @@ public:
 		this->addConfig("Emulator", emuConfig);
 		auto socConfig = new SOCConfig("SOC configuration");
 		this->addConfig("SOC", socConfig);
+		auto dcacheConfig = new L1DCacheConfig("L1 data cache configuration");
+		this->addConfig("L1DCache", dcacheConfig);
+		auto cfuConfig = new CFUConfig("CFU configuration");
+		this->addConfig("CFU", cfuConfig);
+		auto addrMapConfig = new AddressMapConfig("Address map configuration");
+		this->addConfig("AddressMap", addrMapConfig);
+		auto topologyConfig = new TopologyConfig("CrossBar topology configuration");
+		this->addConfig("Topology", topologyConfig);
 	}
 
 	/**
 	 * @brief Registers command-line interface arguments
 	 * @details Sets up CLI options for the simulation:
 	 *          - --asm_file_path: Path to the assembly code file
+	 *          - --elf_file_path: Path to an RV32 ELF executable, which takes precedence over --asm_file_path
+	 *          - --image_cache_dir: Directory of cached assembled program images
 	 * @override Overrides base class method
 	 */
 	void registerCLIArguments() override {
@@ -75,87 +89,22 @@ public:
 		                                "Emulator",                           // Config section
 		                                "asm_file_path"                       // Parameter name
 		);
+		this->addCLIOption<std::string>("--elf_file_path",                          // Option name
+		                                "The file path of an RV32 ELF executable",  // Description
+		                                "Emulator",                                 // Config section
+		                                "elf_file_path"                             // Parameter name
+		);
+		this->addCLIOption<std::string>("--image_cache_dir",                                  // Option name
+		                                "The directory to cache assembled program images in",  // Description
+		                                "Emulator",                                           // Config section
+		                                "image_cache_dir"                                     // Parameter name
+		);
 	}
 
-	void registerSimulators() override {
-		// Get the maximal memory footprint size in the Emulator Configuration
-		size_t mem_size = acalsim::top->getParameter<int>("Emulator", "memory_size");
-
-		// Data Memory Timing Model
-		this->dmem = new DataMemory("DataMemory", mem_size);
-		// XBar
-		this->XBar = new acalsim::crossbar::CrossBar("CrossBar", 3, 3);
-
-		// Instruction Set Architecture Emulator (Functional Model)
-		this->isaEmulator = new Emulator("RISCV RV32I Emulator");
-
-		// CPU Timing Model
-		this->cpu = new CPU("ScCPU", this->isaEmulator);
-
-		// DMA Controller
-		this->dma = new DMAController("DMA");
-
-		// CFU
-		this->cfu = new CFU("CFU");
-
-		// Systolic array
-		this->sa = new SystolicArray("SA");
-
-		// register simulators
-		this->addSimulator(this->cpu);
-		this->addSimulator(this->dmem);
-		this->addSimulator(this->XBar);
-		this->addSimulator(this->dma);
-		this->addSimulator(this->cfu);
-		this->addSimulator(this->sa);
-
-		// still add those upstream & downstream
-		// Keep the dump memory functional
-		this->cpu->addDownStream(this->XBar, "DSBus");
-		this->XBar->addDownStream(this->dmem, "DSDMem");
-		// add CFU
-		this->cpu->addDownStream(this->cfu, "DSCFU");
-		this->cfu->addUpStream(this->cpu, "USCPU");
-
-		// master construction (cpu, dma, systolic array)
-		// Register PRMasterPort to Masters in `SimTop`
-		this->cpu->addPRMasterPort("bus-m", XBar->getPipeRegister("Req", 0));
-		this->dma->addPRMasterPort("bus-m", XBar->getPipeRegister("Req", 1));
-		this->sa->addPRMasterPort("bus-m", XBar->getPipeRegister("Req", 2));
-		// Make SimPort Connection to Slaves in `SimTop`
-		for (auto mp : XBar->getMasterPortsBySlave("Req", 0)) {
-			acalsim::SimPortManager::ConnectPort(XBar, this->dmem, mp->getName(), "bus-s");
-		}
-		for (auto mp : XBar->getMasterPortsBySlave("Req", 1)) {
-			acalsim::SimPortManager::ConnectPort(XBar, this->dma, mp->getName(), "bus-s");
-		}
-		for (auto mp : XBar->getMasterPortsBySlave("Req", 2)) {
-			acalsim::SimPortManager::ConnectPort(XBar, this->sa, mp->getName(), "bus-s");
-		}
-
-		// slave construction (dm)
-		// Register PRMasterPort to Slaves for the response channel
-		this->dmem->addPRMasterPort("bus-m", XBar->getPipeRegister("Resp", 0));
-		// to avoid renaming // send request back to cpu / accelator
-		this->dma->addPRMasterPort("bus-m-2", XBar->getPipeRegister("Resp", 1));
-
-		this->sa->addPRMasterPort("bus-m-2", XBar->getPipeRegister("Resp", 2));
-		// Simport Connection (Bus <> SlavePort at Devices)
-		for (auto mp : XBar->getMasterPortsBySlave("Resp", 0)) {
-			acalsim::SimPortManager::ConnectPort(XBar, this->cpu, mp->getName(), "bus-s");
-		}
-		for (auto mp : XBar->getMasterPortsBySlave("Resp", 1)) {
-			acalsim::SimPortManager::ConnectPort(XBar, this->dma, mp->getName(), "bus-s");
-		}
-
-		for (auto mp : XBar->getMasterPortsBySlave("Resp", 2)) {
-			acalsim::SimPortManager::ConnectPort(XBar, this->sa, mp->getName(), "bus-s");
-		}
-
-		// channel cpu <-> cfu
-		ChannelPortManager::ConnectPort(cpu, cfu, cpu->getName() + "-m_cfu", cfu->getName() + "-s_cpu");
-		ChannelPortManager::ConnectPort(cfu, cpu, cfu->getName() + "-m_cpu", cpu->getName() + "-s_cfu");
-	}
+	/**
+	 * @brief Instantiates the devices listed in the "Topology" section and wires them to an NxM CrossBar
+	 */
+	void registerSimulators() override;
 
 	void postSimInitSetup() override {
 		// Get read latency for the data memory model
@@ -167,13 +116,43 @@ public:
 		CLASS_INFO << " SOC::preSimInitSetup()!";
 
 		// Initialize the ISA Emulator
-		// Parse assmebly file and initialize data memory and instruction memory
-		std::string asm_file_path = acalsim::top->getParameter<std::string>("Emulator", "asm_file_path");
+		// Parse assmebly file (or load the ELF file) and initialize data memory and instruction memory
+		std::string default_program = acalsim::top->getParameter<std::string>("Emulator", "elf_file_path");
+		if (default_program.empty()) {
+			default_program = acalsim::top->getParameter<std::string>("Emulator", "asm_file_path");
+		}
 
-		this->isaEmulator->parse(asm_file_path, ((uint8_t*)this->dmem->getMemPtr()), this->cpu->getIMemPtr());
-		this->isaEmulator->normalize_labels(this->cpu->getIMemPtr());
+		// Each distinct program is parsed once; the cores that run it share a copy of its instruction memory.
+		// The `.data` of every program is loaded into the shared data memory after that of the previous one.
+		size_t imem_bytes = acalsim::top->getParameter<int>("Emulator", "data_offset") / 4 * sizeof(instr);
+		std::map<std::string, CPU*> loaded;
+		for (size_t c = 0; c < this->cpus.size(); c++) {
+			CPU*               cpu  = this->cpus[c];
+			const std::string& path = this->cpuPrograms[c].empty() ? default_program : this->cpuPrograms[c];
+			if (auto it = loaded.find(path); it != loaded.end()) {
+				memcpy(cpu->getIMemPtr(), it->second->getIMemPtr(), imem_bytes);
+				cpu->setEntryPoint(it->second->getEntryPoint());
+				cpu->setSource(it->second->getSource());
+				continue;
+			}
+			this->isaEmulator->beginProgram();
+			if (Emulator::isElf(path)) {
+				cpu->setEntryPoint(
+				    this->isaEmulator->loadElf(path, ((uint8_t*)this->dmem->getMemPtr()), cpu->getIMemPtr()));
+			} else {
+				this->isaEmulator->assemble(path, ((uint8_t*)this->dmem->getMemPtr()), cpu->getIMemPtr());
+				cpu->setSource(this->isaEmulator->programSource());
+			}
+			loaded[path] = cpu;
+		}
+		for (auto cpu : this->cpus) { cpu->predecode(); }
 	}
 
+	/**
+	 * @brief Prints the NoC hop, latency and link statistics when the interconnect is a mesh or a ring
+	 */
+	void reportInterconnect() const { this->noc.report(); }
+
 	void registerPipeRegisters() {
 		this->SimTop::registerPipeRegisters();
 		auto bus = static_cast<acalsim::crossbar::CrossBar*>(this->getSimulator("CrossBar"));
@@ -182,13 +161,32 @@ public:
 	}
 
 private:
-	Emulator*                    isaEmulator;  ///< ISA behavior model for instruction emulation
-	CPU*                         cpu;          ///< Single-cycle CPU hardware model
-	DataMemory*                  dmem;         ///< Data memory subsystem model
-	DMAController*               dma;          ///< DMA controller for data transfer
-	CFU*                         cfu;
-	SystolicArray*               sa;
-	acalsim::crossbar::CrossBar* XBar;
+	/**
+	 * @brief A device attached to the CrossBar
+	 */
+	struct BusDevice {
+		acalsim::SimBase* sim;       ///< The simulator itself
+		MMIOUTIL*         bus;       ///< Its bus identity (master / slave ID, address map)
+		std::string       respPort;  ///< Master port the device answers requests on (slaves only)
+		uint8_t           qos  = 0;  ///< Arbitration priority of the device's requests (masters only)
+		size_t            node = 0;  ///< NoC router the device is attached to
+	};
+
+	/**
+	 * @brief Creates the simulator for one topology entry and registers it (plus any private companion)
+	 */
+	BusDevice createDevice(const DeviceSpec& _spec, size_t _mem_size);
+
+	Emulator*                        isaEmulator;     ///< ISA behavior model for instruction emulation
+	std::vector<CPU*>                cpus;            ///< Single-cycle CPU hardware models, indexed by hart ID
+	std::vector<std::string>         cpuPrograms;     ///< Assembly file of each CPU, empty for the default
+	DataMemory*                      dmem = nullptr;  ///< Data memory subsystem model
+	std::vector<DMAController*>      dmas;            ///< DMA controllers, in declaration order
+	std::vector<SystolicArray*>      systolicArrays;  ///< Systolic array accelerators, in declaration order
+	std::map<std::string, BusDevice> devices;         ///< Bus devices by name
+	acalsim::crossbar::CrossBar*     XBar;
+	AddressMap                       addressMap;      ///< Address -> slave decoding used by all masters
+	NoCModel                         noc;             ///< Hop / link-contention timing of a mesh or ring interconnect
 };
 
 #endif  // SOC_INCLUDE_SOC_HH_
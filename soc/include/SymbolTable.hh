@@ -0,0 +1,70 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_SYMBOLTABLE_HH_
+#define SOC_INCLUDE_SYMBOLTABLE_HH_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class SymbolTable
+ * @brief Interned label names of the program being assembled
+ * @details Every label name, whether seen first in a definition or in a reference, is interned once and identified by
+ *          a dense `SymbolID` from then on. Operands store that ID instead of the name, so resolving a reference is an
+ *          index into `locs` and names have no length or count limit.
+ */
+class SymbolTable {
+public:
+	using SymbolID = uint32_t;
+
+	/**
+	 * @brief ID of `_name`, interning it on first use
+	 */
+	SymbolID intern(std::string_view _name);
+
+	/**
+	 * @brief Bind `_id` to `_loc`
+	 * @return false if the label was already defined; the first definition is kept
+	 */
+	bool define(SymbolID _id, uint32_t _loc);
+
+	bool             isDefined(SymbolID _id) const { return this->locs[_id] >= 0; }
+	uint32_t         location(SymbolID _id) const { return static_cast<uint32_t>(this->locs[_id]); }
+	std::string_view name(SymbolID _id) const { return this->names[_id]; }
+	size_t           size() const { return this->names.size(); }
+
+	/**
+	 * @brief Make room for `_count` labels, e.g. before restoring a whole table at once
+	 */
+	void reserve(size_t _count);
+
+	/**
+	 * @brief Forget every label, e.g. before the next program is assembled
+	 */
+	void clear();
+
+private:
+	std::deque<std::string>                        names;  ///< Indexed by ID; a deque keeps the strings in place
+	std::unordered_map<std::string_view, SymbolID> ids;    ///< Keys view the strings in `names`
+	std::vector<int64_t>                           locs;   ///< Address of each label, -1 while undefined
+};
+
+#endif  // SOC_INCLUDE_SYMBOLTABLE_HH_
@@ -19,8 +19,10 @@
 #define SOC_INCLUDE_SYSTEMCONFIG_HH_
 
 #include <string>
+#include <vector>
 
 #include "ACALSim.hh"
+#include "AddressMap.hh"
 
 using json = nlohmann::json;
 
@@ -39,17 +41,17 @@ public:
 	 *          - memory_size: Total memory size in bytes (default: 65536)
 	 *          - data_offset: Starting offset for data segment (default: 8192)
 	 *          - text_offset: Starting offset for text/code segment (default: 0)
-	 *          - max_label_count: Maximum number of labels supported (default: 128)
-	 *          - max_src_len: Maximum source code length in bytes (default: 1048576)
 	 *          - asm_file_path: Path to the assembly source file (default: empty)
+	 *          - elf_file_path: Path to an RV32 ELF executable, run instead of asm_file_path when set (default: empty)
+	 *          - image_cache_dir: Directory of cached assembled program images, disabled when empty (default: empty)
 	 */
 	EmulatorConfig(const std::string& _name) : acalsim::SimConfig(_name) {
 		this->addParameter<int>("memory_size", 65536, acalsim::ParamType::INT);
 		this->addParameter<int>("data_offset", 8192, acalsim::ParamType::INT);
 		this->addParameter<int>("text_offset", 0, acalsim::ParamType::INT);
-		this->addParameter<int>("max_label_count", 128, acalsim::ParamType::INT);
-		this->addParameter<int>("max_src_len", 1048576, acalsim::ParamType::INT);
 		this->addParameter<std::string>("asm_file_path", "", acalsim::ParamType::STRING);
+		this->addParameter<std::string>("elf_file_path", "", acalsim::ParamType::STRING);
+		this->addParameter<std::string>("image_cache_dir", "", acalsim::ParamType::STRING);
 	}
 
 	/**
@@ -61,8 +63,8 @@ public:
 /**
  * @class SOCConfig
  * @brief Configuration class for System-on-Chip (SOC) timing parameters
- * @details Inherits from SimConfig and defines latency parameters for
- *          memory operations in the system
+ * @details Inherits from SimConfig and defines latency and bandwidth parameters
+ *          for memory operations in the system
  */
 class SOCConfig : public acalsim::SimConfig {
 public:
@@ -72,10 +74,20 @@ public:
 	 * @details Sets up the following parameters:
 	 *          - memory_read_latency: Clock cycles for memory read operations (default: 1)
 	 *          - memory_write_latency: Clock cycles for memory write operations (default: 1)
+	 *          - memory_bytes_per_cycle: Data memory service rate, 0 for unlimited bandwidth (default: 4)
+	 *          - memory_queue_depth: Bursts the data memory accepts before back-pressuring the bus (default: 8)
+	 *          - cpu_quantum: ALU / branch instructions a CPU may execute per event, 1 for one event each (default: 64)
+	 *          - cpu_load_queue_depth: Bus loads a CPU may have in flight, 0 for blocking loads (default: 0)
+	 *          - cpu_write_buffer_depth: Posted stores a CPU may run ahead of, 0 to disable (default: 0)
 	 */
 	SOCConfig(const std::string& _name) : acalsim::SimConfig(_name) {
 		this->addParameter<acalsim::Tick>("memory_read_latency", 1, acalsim::ParamType::TICK);
 		this->addParameter<acalsim::Tick>("memory_write_latency", 1, acalsim::ParamType::TICK);
+		this->addParameter<int>("memory_bytes_per_cycle", 4, acalsim::ParamType::INT);
+		this->addParameter<int>("memory_queue_depth", 8, acalsim::ParamType::INT);
+		this->addParameter<int>("cpu_quantum", 64, acalsim::ParamType::INT);
+		this->addParameter<int>("cpu_load_queue_depth", 0, acalsim::ParamType::INT);
+		this->addParameter<int>("cpu_write_buffer_depth", 0, acalsim::ParamType::INT);
 	}
 
 	/**
@@ -84,4 +96,209 @@ public:
 	~SOCConfig() {}
 };
 
+/**
+ * @class L1DCacheConfig
+ * @brief Configuration class for the CPU's L1 data cache
+ * @details Inherits from SimConfig and defines the geometry and timing of the
+ *          write-back L1 data cache placed between the CPU and the CrossBar
+ */
+class L1DCacheConfig : public acalsim::SimConfig {
+public:
+	/**
+	 * @brief Constructor that initializes L1 data cache parameters
+	 * @param _name Name identifier for the configuration instance
+	 * @details Sets up the following parameters:
+	 *          - enable: 1 to place the cache in front of the CPU, 0 to bypass it (default: 0)
+	 *          - sets: Number of sets, power of two (default: 64)
+	 *          - ways: Associativity (default: 2)
+	 *          - line_size: Line size in bytes, power of two (default: 16)
+	 *          - hit_latency: Clock cycles for a hit (default: 1)
+	 *          - policy: Replacement policy, "lru" or "plru" (default: "lru")
+	 */
+	L1DCacheConfig(const std::string& _name) : acalsim::SimConfig(_name) {
+		this->addParameter<int>("enable", 0, acalsim::ParamType::INT);
+		this->addParameter<int>("sets", 64, acalsim::ParamType::INT);
+		this->addParameter<int>("ways", 2, acalsim::ParamType::INT);
+		this->addParameter<int>("line_size", 16, acalsim::ParamType::INT);
+		this->addParameter<acalsim::Tick>("hit_latency", 1, acalsim::ParamType::TICK);
+		this->addParameter<std::string>("policy", "lru", acalsim::ParamType::STRING);
+	}
+
+	/**
+	 * @brief Default destructor
+	 */
+	~L1DCacheConfig() {}
+};
+
+/**
+ * @brief Timing override of one CFU instruction
+ */
+struct CFUOpTiming {
+	std::string op;            ///< Assembly mnemonic, e.g. "spmuli8i16s.vv.l"
+	int         latency = -1;  ///< Ticks from issue to result, -1 for the section default
+	int         ii      = -1;  ///< Initiation interval, -1 for the section default
+};
+
+/**
+ * @class CFUConfig
+ * @brief Configuration class for the pipelined CFU
+ * @details Inherits from SimConfig and defines the timing of the CFU's add/sub and multiply units
+ */
+class CFUConfig : public acalsim::SimConfig {
+public:
+	/**
+	 * @brief Constructor that initializes the CFU timing parameters
+	 * @param _name Name identifier for the configuration instance
+	 * @details Sets up the following parameters:
+	 *          - latency: Ticks from accepting an op to sending its result (default: 1)
+	 *          - ii: Initiation interval, ticks before a pipeline accepts its next op (default: 1)
+	 *          - issue_width: Pipelines per functional unit, i.e. ops of one unit that may start together
+	 *            (default: 1)
+	 *          - ops: List of `{op, latency, ii}` overrides keyed by mnemonic (default: empty)
+	 */
+	CFUConfig(const std::string& _name) : acalsim::SimConfig(_name) {
+		this->addParameter<acalsim::Tick>("latency", 1, acalsim::ParamType::TICK);
+		this->addParameter<acalsim::Tick>("ii", 1, acalsim::ParamType::TICK);
+		this->addParameter<int>("issue_width", 1, acalsim::ParamType::INT);
+		this->addParameter<std::vector<CFUOpTiming>>("ops", {}, acalsim::ParamType::USER_DEFINED);
+	}
+
+	/**
+	 * @brief Default destructor
+	 */
+	~CFUConfig() {}
+
+	void parseParametersUserDefined(const std::string& _param_name, const json& _param_value) override {
+		if (_param_name != "ops") return;
+		std::vector<CFUOpTiming> ops;
+		for (const auto& entry : _param_value) {
+			ops.push_back({entry.at("op").get<std::string>(), entry.value("latency", -1), entry.value("ii", -1)});
+		}
+		this->setParameter<std::vector<CFUOpTiming>>("ops", ops);
+	}
+};
+
+/**
+ * @class AddressMapConfig
+ * @brief Configuration class for the CrossBar address map
+ * @details Inherits from SimConfig and declares which address ranges are served by which CrossBar slave.
+ *          Each entry of `regions` is an object with `name`, `base`, `size` and `slave`; `base` and `size`
+ *          may be given as integers or as strings such as "0xF000".
+ */
+class AddressMapConfig : public acalsim::SimConfig {
+public:
+	/**
+	 * @brief Constructor that initializes the address map parameters
+	 * @param _name Name identifier for the configuration instance
+	 * @details Sets up the following parameters:
+	 *          - default_slave: Slave serving addresses outside every region, the data memory (default: 0)
+	 *          - regions: List of address regions (default: the DMA and systolic array windows)
+	 */
+	AddressMapConfig(const std::string& _name) : acalsim::SimConfig(_name) {
+		this->addParameter<int>("default_slave", 0, acalsim::ParamType::INT);
+		this->addParameter<std::vector<AddressRegion>>("regions",
+		                                               {{"dma-mmio", 0xF000, 0x40, 1},
+		                                                {"sa-mmio", 0x12000, 0xF1, 2},
+		                                                {"sa-memory", 0x20000, 0x8001, 2}},
+		                                               acalsim::ParamType::USER_DEFINED);
+	}
+
+	/**
+	 * @brief Default destructor
+	 */
+	~AddressMapConfig() {}
+
+	void parseParametersUserDefined(const std::string& _param_name, const json& _param_value) override {
+		if (_param_name != "regions") return;
+		std::vector<AddressRegion> regions;
+		for (const auto& entry : _param_value) {
+			AddressRegion r;
+			r.name  = entry.value("name", "region" + std::to_string(regions.size()));
+			r.base  = static_cast<uint32_t>(parseAddress(entry.at("base")));
+			r.size  = parseAddress(entry.at("size"));
+			r.slave = entry.at("slave").get<size_t>();
+			regions.push_back(r);
+		}
+		this->setParameter<std::vector<AddressRegion>>("regions", regions);
+	}
+
+private:
+	static uint64_t parseAddress(const json& _value) {
+		if (_value.is_string()) return std::stoull(_value.get<std::string>(), nullptr, 0);
+		return _value.get<uint64_t>();
+	}
+};
+
+/**
+ * @brief One simulator instance declared in the topology
+ */
+struct DeviceSpec {
+	std::string name;         ///< Simulator name, also used to reference the device in `masters` / `slaves`
+	std::string type;         ///< "cpu", "memory", "dma" or "systolic_array"
+	int         qos     = 0;   ///< Arbitration priority of the requests the device issues as a master
+	std::string arbiter = "";  ///< Arbitration policy of a memory device, empty for the default
+	int         node    = -1;  ///< NoC router the device attaches to, -1 for the next free one
+	std::string program = "";  ///< Assembly or ELF file a CPU runs, empty for the Emulator default
+};
+
+/**
+ * @class TopologyConfig
+ * @brief Configuration class for the devices attached to the CrossBar
+ * @details Inherits from SimConfig and lists the devices the SoC instantiates and how they attach to the CrossBar.
+ *          The position of a device in `masters` is its request port (and `MasterID`); its position in `slaves` is
+ *          the slave index used by the address map. The CrossBar is sized `masters.size() x slaves.size()`.
+ *          A device entry may also set `qos` (master priority, 0-255), `node` (NoC router), `program` (the
+ *          assembly file of a CPU) and, for the memory, `arbiter`. With `interconnect` set to "mesh" or "ring" the
+ *          CrossBar is timed as a network of routers, see `NoCModel`.
+ */
+class TopologyConfig : public acalsim::SimConfig {
+public:
+	/**
+	 * @brief Constructor that initializes the topology parameters
+	 * @param _name Name identifier for the configuration instance
+	 * @details Sets up the following parameters:
+	 *          - devices: List of `{name, type[, qos][, node][, program][, arbiter]}` objects
+	 *            (default: ScCPU, DataMemory, DMA, SA)
+	 *          - masters: Device names attached as bus masters (default: ScCPU, DMA, SA)
+	 *          - slaves: Device names attached as bus slaves (default: DataMemory, DMA, SA)
+	 *          - interconnect: "crossbar", "mesh" or "ring" (default: crossbar)
+	 *          - noc_cols / noc_rows: Router grid of the mesh; a ring has noc_cols * noc_rows routers (default: 2x2)
+	 *          - router_latency: Ticks a flit spends in each router (default: 1)
+	 *          - link_width: Bytes a NoC link carries per tick (default: 4)
+	 */
+	TopologyConfig(const std::string& _name) : acalsim::SimConfig(_name) {
+		this->addParameter<std::vector<DeviceSpec>>(
+		    "devices", {{"ScCPU", "cpu"}, {"DataMemory", "memory"}, {"DMA", "dma"}, {"SA", "systolic_array"}},
+		    acalsim::ParamType::USER_DEFINED);
+		this->addParameter<std::vector<std::string>>("masters", {"ScCPU", "DMA", "SA"},
+		                                             acalsim::ParamType::USER_DEFINED);
+		this->addParameter<std::vector<std::string>>("slaves", {"DataMemory", "DMA", "SA"},
+		                                             acalsim::ParamType::USER_DEFINED);
+		this->addParameter<std::string>("interconnect", "crossbar", acalsim::ParamType::STRING);
+		this->addParameter<int>("noc_cols", 2, acalsim::ParamType::INT);
+		this->addParameter<int>("noc_rows", 2, acalsim::ParamType::INT);
+		this->addParameter<acalsim::Tick>("router_latency", 1, acalsim::ParamType::TICK);
+		this->addParameter<int>("link_width", 4, acalsim::ParamType::INT);
+	}
+
+	/**
+	 * @brief Default destructor
+	 */
+	~TopologyConfig() {}
+
+	void parseParametersUserDefined(const std::string& _param_name, const json& _param_value) override {
+		if (_param_name == "devices") {
+			std::vector<DeviceSpec> devices;
+			for (const auto& entry : _param_value) {
+				devices.push_back({entry.at("name").get<std::string>(), entry.at("type").get<std::string>(),
+				                   entry.value("qos", 0), entry.value("arbiter", std::string()),
+				                   entry.value("node", -1), entry.value("program", std::string())});
+			}
+			this->setParameter<std::vector<DeviceSpec>>("devices", devices);
+		} else if (_param_name == "masters" || _param_name == "slaves") {
+			this->setParameter<std::vector<std::string>>(_param_name, _param_value.get<std::vector<std::string>>());
+		}
+	}
+};
+
 #endif  // SOC_INCLUDE_SYSTEMCONFIG_HH_
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "ACALSim.hh"
+#include "BaseMemory.hh"
 #include "DataMemory.hh"
 #include "MMIOUtil.hh"
 #include "packet/XBarPacket.hh"
@@ -41,11 +42,19 @@ public:
 	void init() override;
 	void step() override;
 	void masterPortRetry(const std::string& portName) final;
+	void receiveBusPacket(XBarPacket* pkt) override;
+
+	// MMIO window of the DMA channel the SA programs, looked up in the address map by the SoC
+	void setDMABase(uint32_t _base) { this->dmaBase = _base; }
 
 	// MMIO interface
 	void readMMIO(acalsim::Tick when, XBarMemReadReqPayload* req);
 	void writeMMIO(acalsim::Tick when, XBarMemWriteReqPayload* req);
 
+	// Crossbar request handlers (MMIO or on-chip SRAM access)
+	void handleReadRequest(XBarMemReadReqPacket* pkt);
+	void handleWriteRequest(XBarMemWriteReqPacket* pkt);
+
 	// Crossbar response handlers
 	void handleReadResponse(XBarMemReadRespPacket* pkt);
 	void handleWriteCompletion(XBarMemWriteRespPacket* pkt);
@@ -83,6 +92,8 @@ private:
 	// Print Utility
 	std::string instrToString(instr_type _op) const;
 	void        DumpMemory() const;
+	// Base of the DMA MMIO window, see setDMABase()
+	uint32_t dmaBase = 0;
 	// Configuration registers
 	bool     enabled_ = false;
 	bool     done_    = false;
@@ -114,7 +125,7 @@ private:
 	void     launchNextTile();
 	TileTask current_tile;
 	/* ---------- on‑chip SRAM ---------- */
-	uint32_t sram_[SA_SRAM_SIZE]{};
+	BaseMemory sram_;  // SA_SRAM_SIZE words
 
 	/* ---------- burst tracking (same idea as DataMemory) ---------- */
 	struct BurstTracker {
@@ -132,6 +143,8 @@ private:
 	acalsim::SimPipeRegister*       m_resp_ = nullptr;
 	std::queue<acalsim::SimPacket*> req_Q_;
 	std::queue<acalsim::SimPacket*> resp_Q_;
+
+	PacketDispatchTable<SystolicArray, XBarPacket> busHandlers_;
 };
 
 #endif  // SOC_INCLUDE_SYSTOLICARRAY_HH_
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_EVENT_CFURESULTEVENT_HH_
+#define SOC_INCLUDE_EVENT_CFURESULTEVENT_HH_
+
+#include "ACALSim.hh"
+
+class CFU;
+class CFURespPacket;
+
+/**
+ * @class CFUResultEvent
+ * @brief Returns the result of a CFU op to the CPU once its latency has elapsed
+ */
+class CFUResultEvent : public acalsim::SimEvent {
+public:
+	CFUResultEvent() = default;
+	CFUResultEvent(CFU* _cfu, CFURespPacket* _pkt);
+	virtual ~CFUResultEvent() = default;
+
+	void renew(CFU* _cfu, CFURespPacket* _pkt);
+	void process() override;
+
+private:
+	CFU*           cfu;
+	CFURespPacket* pkt;
+};
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_EVENT_MEMCOMPLETIONEVENT_HH_
+#define SOC_INCLUDE_EVENT_MEMCOMPLETIONEVENT_HH_
+
+#include "ACALSim.hh"
+
+class DataMemory;
+
+/**
+ * @class MemCompletionEvent
+ * @brief Wakes up the DataMemory to retire every entry of its completion queue that is due
+ */
+class MemCompletionEvent : public acalsim::SimEvent {
+public:
+	MemCompletionEvent() = default;
+	MemCompletionEvent(DataMemory* _dm);
+	virtual ~MemCompletionEvent() = default;
+
+	void renew(DataMemory* _dm);
+	void process() override;
+
+private:
+	DataMemory* dm;
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOC_INCLUDE_EVENT_NETARRIVALEVENT_HH_
+#define SOC_INCLUDE_EVENT_NETARRIVALEVENT_HH_
+
+#include "ACALSim.hh"
+
+class MMIOUTIL;
+class XBarPacket;
+
+/**
+ * @class NetArrivalEvent
+ * @brief Hands a bus packet to its receiver once the last flit has crossed the network
+ */
+class NetArrivalEvent : public acalsim::SimEvent {
+public:
+	NetArrivalEvent() = default;
+	NetArrivalEvent(MMIOUTIL* _owner, XBarPacket* _pkt);
+	virtual ~NetArrivalEvent() = default;
+
+	void renew(MMIOUTIL* _owner, XBarPacket* _pkt);
+	void process() override;
+
+private:
+	MMIOUTIL*   owner;
+	XBarPacket* pkt;
+};
+
+#endif
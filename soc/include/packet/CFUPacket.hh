@@ -1,16 +1,26 @@
 #ifndef SOC_INCLUDE_PACKET_CFUPACKET_HH_
 #define SOC_INCLUDE_PACKET_CFUPACKET_HH_
 
+#include <array>
 #include <cstdint>
 
 #include "ACALSim.hh"
 #include "DataStruct.hh"
+#include "packet/PacketKind.hh"
+
+/** @brief One 128-bit vector register, least significant 32-bit slice first */
+using VReg = std::array<uint32_t, VREG_WORDS>;
+
+/** @brief Whether `_op` is a packed CFU op on vector registers */
+inline bool isVectorCfuOp(instr_type _op) { return _op >= V_ADDI8I8S_VV && _op <= V_AMULI8I8S_VV_L; }
 
 /**
  * @brief CFU computation packet (input: instr, rs1, rs2; output: rd, instr)
  */
 class CFUReqPacket : public acalsim::SimPacket {
 public:
+	static constexpr PacketKind kKind = PacketKind::CFU_REQ;
+
 	CFUReqPacket() {}
 
 	CFUReqPacket(const instr& _i, uint32_t _rs1, uint32_t _rs2) : i(_i), rs1(_rs1), rs2(_rs2) {}
@@ -25,20 +35,33 @@ public:
 		rs2 = _rs2;
 	}
 
+	/// Renew as a vector op on two vector registers
+	void renewVector(const instr& _i, const VReg& _vs1, const VReg& _vs2) {
+		this->acalsim::SimPacket::renew();
+		i   = _i;
+		vs1 = _vs1;
+		vs2 = _vs2;
+	}
+
 	/// Visit simulation module (to be implemented)
 	void visit(acalsim::Tick _when, acalsim::SimModule& _module) override;
 	/// Visit simulation base (to be implemented)
 	void visit(acalsim::Tick _when, acalsim::SimBase& _simulator) override;
 
 	// Getters
+	PacketKind   getKind() const { return kKind; }
 	const instr& getInstr() const { return i; }
 	uint32_t     getRs1() const { return rs1; }
 	uint32_t     getRs2() const { return rs2; }
+	const VReg&  getVs1() const { return vs1; }
+	const VReg&  getVs2() const { return vs2; }
 
 private:
 	instr    i;
 	uint32_t rs1 = 0;
 	uint32_t rs2 = 0;
+	VReg     vs1{};  ///< Vector ops only
+	VReg     vs2{};  ///< Vector ops only
 };
 
 /**
@@ -46,6 +69,8 @@ private:
  */
 class CFURespPacket : public acalsim::SimPacket {
 public:
+	static constexpr PacketKind kKind = PacketKind::CFU_RESP;
+
 	CFURespPacket() {}
 
 	CFURespPacket(const instr& _i, uint32_t _rd) : i(_i), rd(_rd) {}
@@ -58,17 +83,27 @@ public:
 		i  = _i;
 		rd = _rd;
 	}
+
+	/// Renew as the result of a vector op
+	void renewVector(const instr& _i, const VReg& _vd) {
+		this->acalsim::SimPacket::renew();
+		i  = _i;
+		vd = _vd;
+	}
 	/// Visit simulation module (to be implemented)
 	void visit(acalsim::Tick _when, acalsim::SimModule& _module) override;
 	/// Visit simulation base (to be implemented)
 	void visit(acalsim::Tick _when, acalsim::SimBase& _simulator) override;
 
+	PacketKind   getKind() const { return kKind; }
 	const instr& getInstr() const { return i; }
 	uint32_t     getRd() const { return rd; }
+	const VReg&  getVd() const { return vd; }
 
 private:
 	instr    i;
 	uint32_t rd = 0;
+	VReg     vd{};  ///< Vector ops only
 };
 
 #endif  // SOC_INCLUDE_PACKET_CFUPACKET_HH_
@@ -0,0 +1,65 @@
+#ifndef SOC_INCLUDE_PACKET_PACKETKIND_HH_
+#define SOC_INCLUDE_PACKET_PACKETKIND_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Kind tag carried by every packet defined in this SoC
+ * @details The tag is fixed by the concrete packet class, so receivers can branch on it instead of probing the
+ *          packet with a chain of `dynamic_cast`s.
+ */
+enum class PacketKind : uint8_t {
+	MEM_READ_REQ = 0,
+	MEM_WRITE_REQ,
+	MEM_READ_RESP,
+	MEM_WRITE_RESP,
+	CFU_REQ,
+	CFU_RESP,
+	NUM_KINDS
+};
+
+/**
+ * @brief Per-device table mapping a packet kind to a member-function handler
+ * @tparam Owner The device that owns the handlers
+ * @tparam Packet Common base of the packets the table dispatches (e.g. `XBarPacket`)
+ * @details Handlers are registered once, typically in the device constructor, with `on<&Owner::handler>()`. The
+ *          handler's parameter type names the concrete packet class, whose `kKind` selects the table slot, so the
+ *          downcast in the generated trampoline is checked by construction.
+ */
+template <typename Owner, typename Packet>
+class PacketDispatchTable {
+public:
+	template <auto Handler>
+	void on() {
+		using Concrete = typename HandlerTraits<decltype(Handler)>::Concrete;
+		this->thunks[static_cast<size_t>(Concrete::kKind)] = [](Owner* _owner, Packet* _pkt) {
+			(_owner->*Handler)(static_cast<Concrete*>(_pkt));
+		};
+	}
+
+	/**
+	 * @brief Call the handler registered for the packet's kind
+	 * @return false when no handler is registered; the caller reports the packet as unknown
+	 */
+	bool dispatch(Owner* _owner, Packet* _pkt) const {
+		size_t idx = static_cast<size_t>(_pkt->getKind());
+		if (idx >= this->thunks.size() || !this->thunks[idx]) return false;
+		this->thunks[idx](_owner, _pkt);
+		return true;
+	}
+
+private:
+	template <typename F>
+	struct HandlerTraits;
+	template <typename C>
+	struct HandlerTraits<void (Owner::*)(C*)> {
+		using Concrete = C;
+	};
+
+	using Thunk = void (*)(Owner*, Packet*);
+	std::array<Thunk, static_cast<size_t>(PacketKind::NUM_KINDS)> thunks{};
+};
+
+#endif  // SOC_INCLUDE_PACKET_PACKETKIND_HH_
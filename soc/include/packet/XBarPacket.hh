@@ -1,97 +1,171 @@
 #ifndef SOC_INCLUDE_XBAR_PACKET_HH_
 #define SOC_INCLUDE_XBAR_PACKET_HH_
+#include <algorithm>
+#include <array>
+#include <span>
+
 #include "ACALSim.hh"
 #include "DataStruct.hh"
+#include "packet/PacketKind.hh"
 // forward class
 class XBarMemReadReqPayload;
 class XBarMemWriteReqPayload;
 class XBarMemReadRespPayload;
 class XBarMemWriteRespPayload;
 
+/** @brief Compact bus-master identifier; equals the master's request port index on the CrossBar */
+using MasterID = uint8_t;
+
 class BurstModeBusPacket {
 public:
-	/** @brief Constructor that initializes burst mode and assigns a unique TransactionID */
-	explicit BurstModeBusPacket(int burstMode = 0, std::string caller = "IDK")
-	    : burstSize(pow(2, burstMode)), burstLength(burstMode), Caller(caller) {}
-
-	int         getBurstLen() const { return burstLength; }
-	int         getBurstSize() const { return burstSize; }
-	int         getAutoIncTID() const { return TransactionID; }
-	void        setTID(int tid) { TransactionID = tid; }
-	std::string getCallerName() const { return Caller; }
-	static int  generateTransactionID() {
-        static std::atomic<int> transactionCounter{0};  // Atomic counter for thread safety
-        return transactionCounter++;
+	/** @brief Longest supported burst (burst mode 2) */
+	static constexpr size_t kMaxBurstBeats = 4;
+
+	/** @brief Constructor that initializes burst mode; the issuing master assigns the TransactionID */
+	explicit BurstModeBusPacket(int burstMode = 0) : burstSize(pow(2, burstMode)), burstLength(burstMode) {}
+
+	int           getBurstLen() const { return burstLength; }
+	int           getBurstSize() const { return burstSize; }
+	int           getAutoIncTID() const { return TransactionID; }
+	void          setTID(int tid) { TransactionID = tid; }
+	uint8_t       getQoS() const { return qos; }
+	acalsim::Tick getIssueTick() const { return issueTick; }
+	/** @brief Stamp the QoS level of the issuing master and the tick the request entered the bus */
+	void setIssue(uint8_t _qos, acalsim::Tick _tick) {
+		qos       = _qos;
+		issueTick = _tick;
+	}
+
+	/** @brief A transaction ID holds the master ID above a 24-bit per-master sequence number */
+	static constexpr int      kTidSeqBits    = 24;
+	static constexpr uint32_t kTidSeqMask    = (1u << kTidSeqBits) - 1;
+	static constexpr size_t   kMaxTidMasters = 128;  ///< master IDs that keep the TID non-negative
+
+	/**
+	 * @brief Build a transaction ID from the issuing master and that master's own sequence number
+	 * @details Each master numbers its transactions independently, so no counter is shared between simulator
+	 *          threads and a slave can tell two masters' transactions apart without looking at the port.
+	 */
+	static int makeTID(MasterID _master, uint32_t _seq) {
+		return static_cast<int>((static_cast<uint32_t>(_master) << kTidSeqBits) | (_seq & kTidSeqMask));
 	}
+	static MasterID masterOfTID(int _tid) { return static_cast<MasterID>(static_cast<uint32_t>(_tid) >> kTidSeqBits); }
+	static uint32_t seqOfTID(int _tid) { return static_cast<uint32_t>(_tid) & kTidSeqMask; }
+
+protected:
+	int           TransactionID = -1;
+	int           burstLength;
+	int           burstSize;
+	uint8_t       qos       = 0;  ///< arbitration priority of the issuing master
+	acalsim::Tick issueTick = 0;  ///< tick the request was issued, for latency statistics
+};
+
+/**
+ * @brief Common base of every packet carried by the CrossBars
+ * @details Everything popped from a bus slave port is an `XBarPacket`, so receivers read the kind tag and dispatch
+ *          without probing the concrete type.
+ */
+class XBarPacket : public acalsim::crossbar::CrossBarPacket, public BurstModeBusPacket {
+public:
+	PacketKind getKind() const { return this->kind; }
+
+	/** @brief Tick the packet's tail reaches its destination router; 0 when the interconnect adds no delay */
+	acalsim::Tick getNetArrival() const { return this->netArrival; }
+	void          setNetArrival(acalsim::Tick _tick) { this->netArrival = _tick; }
 
 protected:
-	std::string Caller;
-	int         TransactionID;
-	int         burstLength;
-	int         burstSize;
+	XBarPacket(PacketKind _kind, int burstMode, size_t src_idx, size_t dst_idx)
+	    : acalsim::crossbar::CrossBarPacket(src_idx, dst_idx), BurstModeBusPacket(burstMode), kind(_kind) {}
+
+private:
+	PacketKind    kind;
+	acalsim::Tick netArrival = 0;
 };
 
-template <typename PayloadType>
-class XBarMemPacket : public acalsim::crossbar::CrossBarPacket, public BurstModeBusPacket {
+template <typename PayloadType, PacketKind Kind>
+class XBarMemPacket : public XBarPacket {
 public:
-	XBarMemPacket() : acalsim::crossbar::CrossBarPacket(0, 0), BurstModeBusPacket(0) {}
+	static constexpr PacketKind kKind = Kind;
+
+	XBarMemPacket() : XBarPacket(Kind, 0, 0, 0) {}
 
-	XBarMemPacket(int burstMode, const std::vector<PayloadType*>& payloads, size_t src_idx = 0, size_t dst_idx = 0)
-	    : acalsim::crossbar::CrossBarPacket(src_idx, dst_idx), BurstModeBusPacket(burstMode), payloadList(payloads) {}
+	XBarMemPacket(int burstMode, std::span<PayloadType* const> payloads, size_t src_idx = 0, size_t dst_idx = 0)
+	    : XBarPacket(Kind, burstMode, src_idx, dst_idx) {
+		this->setPayloads(payloads);
+	}
 
 	~XBarMemPacket() override = default;
 
-	void renew(int burstMode, const std::vector<PayloadType*>& payloads, size_t src_idx = 0, size_t dst_idx = 0,
-	           bool required_new_tid = false) {
+	void renew(int burstMode, std::span<PayloadType* const> payloads, size_t src_idx = 0, size_t dst_idx = 0) {
 		this->acalsim::crossbar::CrossBarPacket::renew(src_idx, dst_idx);
 		this->burstLength = burstMode;
 		this->burstSize   = std::pow(2, burstMode);
-		this->payloadList = payloads;
-		if (required_new_tid) { this->TransactionID = generateTransactionID(); }
+		this->setPayloads(payloads);
+		this->setNetArrival(0);
+		this->TransactionID = -1;
 	}
 
-	std::vector<PayloadType*> getPayloads() const { return payloadList; }
+	/**
+	 * @brief The payloads of this burst, one per beat
+	 * @warning The view aliases the packet; copy the pointers out before the packet is recycled
+	 */
+	std::span<PayloadType* const> getPayloads() const { return {this->payloadList.data(), this->numPayloads}; }
 
 	void visit(acalsim::Tick when, acalsim::SimModule& module) override {}
 	void visit(acalsim::Tick when, acalsim::SimBase& simulator) override{};
 
 private:
-	std::vector<PayloadType*> payloadList;
+	void setPayloads(std::span<PayloadType* const> payloads) {
+		assert(payloads.size() <= kMaxBurstBeats);
+		std::copy(payloads.begin(), payloads.end(), this->payloadList.begin());
+		this->numPayloads = payloads.size();
+	}
+
+	std::array<PayloadType*, kMaxBurstBeats> payloadList{};
+	size_t                                   numPayloads = 0;
 };
 
-class XBarMemReadReqPacket : public XBarMemPacket<XBarMemReadReqPayload> {
+class XBarMemReadReqPacket : public XBarMemPacket<XBarMemReadReqPayload, PacketKind::MEM_READ_REQ> {
+	using Base = XBarMemPacket<XBarMemReadReqPayload, PacketKind::MEM_READ_REQ>;
+
 public:
-	using XBarMemPacket<XBarMemReadReqPayload>::XBarMemPacket;
-	void renew(int burstMode, const std::vector<XBarMemReadReqPayload*>& payloads, size_t src_idx = 0,
-	           size_t dst_idx = 0, bool required_new_tid = false) {
-		XBarMemPacket<XBarMemReadReqPayload>::renew(burstMode, payloads, src_idx, dst_idx, required_new_tid);
+	using Base::Base;
+	void renew(int burstMode, std::span<XBarMemReadReqPayload* const> payloads, size_t src_idx = 0,
+	           size_t dst_idx = 0) {
+		Base::renew(burstMode, payloads, src_idx, dst_idx);
 	}
 };
 
-class XBarMemWriteReqPacket : public XBarMemPacket<XBarMemWriteReqPayload> {
+class XBarMemWriteReqPacket : public XBarMemPacket<XBarMemWriteReqPayload, PacketKind::MEM_WRITE_REQ> {
+	using Base = XBarMemPacket<XBarMemWriteReqPayload, PacketKind::MEM_WRITE_REQ>;
+
 public:
-	using XBarMemPacket<XBarMemWriteReqPayload>::XBarMemPacket;
-	void renew(int burstMode, const std::vector<XBarMemWriteReqPayload*>& payloads, size_t src_idx = 0,
-	           size_t dst_idx = 0, bool required_new_tid = false) {
-		XBarMemPacket<XBarMemWriteReqPayload>::renew(burstMode, payloads, src_idx, dst_idx, required_new_tid);
+	using Base::Base;
+	void renew(int burstMode, std::span<XBarMemWriteReqPayload* const> payloads, size_t src_idx = 0,
+	           size_t dst_idx = 0) {
+		Base::renew(burstMode, payloads, src_idx, dst_idx);
 	}
 };
 
-class XBarMemReadRespPacket : public XBarMemPacket<XBarMemReadRespPayload> {
+class XBarMemReadRespPacket : public XBarMemPacket<XBarMemReadRespPayload, PacketKind::MEM_READ_RESP> {
+	using Base = XBarMemPacket<XBarMemReadRespPayload, PacketKind::MEM_READ_RESP>;
+
 public:
-	using XBarMemPacket<XBarMemReadRespPayload>::XBarMemPacket;
-	void renew(int burstMode, const std::vector<XBarMemReadRespPayload*>& payloads, size_t src_idx = 0,
-	           size_t dst_idx = 0, bool required_new_tid = false) {
-		XBarMemPacket<XBarMemReadRespPayload>::renew(burstMode, payloads, src_idx, dst_idx, required_new_tid);
+	using Base::Base;
+	void renew(int burstMode, std::span<XBarMemReadRespPayload* const> payloads, size_t src_idx = 0,
+	           size_t dst_idx = 0) {
+		Base::renew(burstMode, payloads, src_idx, dst_idx);
 	}
 };
 
-class XBarMemWriteRespPacket : public XBarMemPacket<XBarMemWriteRespPayload> {
+class XBarMemWriteRespPacket : public XBarMemPacket<XBarMemWriteRespPayload, PacketKind::MEM_WRITE_RESP> {
+	using Base = XBarMemPacket<XBarMemWriteRespPayload, PacketKind::MEM_WRITE_RESP>;
+
 public:
-	using XBarMemPacket<XBarMemWriteRespPayload>::XBarMemPacket;
-	void renew(int burstMode, const std::vector<XBarMemWriteRespPayload*>& payloads, size_t src_idx = 0,
-	           size_t dst_idx = 0, bool required_new_tid = false) {
-		XBarMemPacket<XBarMemWriteRespPayload>::renew(burstMode, payloads, src_idx, dst_idx, required_new_tid);
+	using Base::Base;
+	void renew(int burstMode, std::span<XBarMemWriteRespPayload* const> payloads, size_t src_idx = 0,
+	           size_t dst_idx = 0) {
+		Base::renew(burstMode, payloads, src_idx, dst_idx);
 	}
 };
 
@@ -111,20 +185,20 @@ public:
 
 	void         setTid(int _tid) { this->tid = _tid; }
 	int          getTid() const { return this->tid; }
-	std::string  getCaller() const { return this->Caller; }
-	void         setCaller(std::string _caller) { this->Caller = _caller; }
+	MasterID     getMaster() const { return this->master; }
+	void         setMaster(MasterID _master) { this->master = _master; }
 	const instr& getInstr() const { return i; }
 	instr_type   getOP() const { return op; }
 	uint32_t     getAddr() const { return addr; }
 	operand      getA1() const { return a1; }
 
 private:
-	std::string Caller;
-	int         tid;
-	instr       i;
-	instr_type  op;
-	uint32_t    addr;
-	operand     a1;
+	MasterID   master = 0;
+	int        tid;
+	instr      i;
+	instr_type op;
+	uint32_t   addr;
+	operand    a1;
 };
 
 class XBarMemWriteReqPayload : public acalsim::RecyclableObject {
@@ -143,20 +217,20 @@ public:
 
 	void         setTid(int _tid) { this->tid = _tid; }
 	int          getTid() const { return this->tid; }
-	std::string  getCaller() const { return this->Caller; }
-	void         setCaller(std::string _caller) { this->Caller = _caller; }
+	MasterID     getMaster() const { return this->master; }
+	void         setMaster(MasterID _master) { this->master = _master; }
 	const instr& getInstr() const { return i; }
 	instr_type   getOP() const { return op; }
 	uint32_t     getAddr() const { return addr; }
 	uint32_t     getData() const { return data; }
 
 private:
-	std::string Caller;
-	int         tid;
-	instr       i;
-	instr_type  op;
-	uint32_t    addr;
-	uint32_t    data;
+	MasterID   master = 0;
+	int        tid;
+	instr      i;
+	instr_type op;
+	uint32_t   addr;
+	uint32_t   data;
 };
 
 class XBarMemReadRespPayload : public acalsim::RecyclableObject {
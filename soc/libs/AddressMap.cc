@@ -0,0 +1,64 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AddressMap.hh"
+
+#include <algorithm>
+
+#include "ACALSim.hh"
+
+void AddressMap::build(std::vector<AddressRegion> _regions, size_t _default_slave, size_t _num_slaves) {
+	LABELED_ASSERT(_default_slave < _num_slaves, "AddressMap: the default slave is not a CrossBar slave");
+	std::sort(_regions.begin(), _regions.end(),
+	          [](const AddressRegion& _a, const AddressRegion& _b) { return _a.base < _b.base; });
+
+	for (size_t i = 0; i < _regions.size(); i++) {
+		const AddressRegion& r = _regions[i];
+		if (r.size == 0 || (uint64_t)r.base + r.size > (1ull << 32)) {
+			ERROR << "AddressMap: region " << r.name << " is empty or wraps around the address space";
+		}
+		if (r.slave >= _num_slaves) {
+			ERROR << "AddressMap: region " << r.name << " targets unknown slave " << r.slave;
+		}
+		if (i > 0 && (uint64_t)_regions[i - 1].base + _regions[i - 1].size > r.base) {
+			ERROR << "AddressMap: region " << _regions[i - 1].name << " overlaps " << r.name;
+		}
+	}
+
+	this->regions      = std::move(_regions);
+	this->defaultSlave = _default_slave;
+	this->bases.clear();
+	for (const auto& r : this->regions) { this->bases.push_back(r.base); }
+
+	for (const auto& r : this->regions) {
+		LABELED_INFO("AddressMap") << r.name << ": [0x" << std::hex << r.base << ", 0x" << (uint64_t)r.base + r.size
+		                           << ") -> slave " << std::dec << r.slave;
+	}
+}
+
+size_t AddressMap::decode(uint32_t _addr) const {
+	// The last region whose base is not above the address is the only candidate
+	auto it = std::upper_bound(this->bases.begin(), this->bases.end(), _addr);
+	if (it == this->bases.begin()) return this->defaultSlave;
+	const AddressRegion& r = this->regions[it - this->bases.begin() - 1];
+	return (uint64_t)_addr - r.base < r.size ? r.slave : this->defaultSlave;
+}
+
+const AddressRegion* AddressMap::findSlave(size_t _slave) const {
+	auto it = std::find_if(this->regions.begin(), this->regions.end(),
+	                       [_slave](const AddressRegion& _r) { return _r.slave == _slave; });
+	return it == this->regions.end() ? nullptr : &*it;
+}
@@ -27,21 +27,17 @@ BaseMemory::~BaseMemory() { std::free(this->mem); }
 
 size_t BaseMemory::getSize() const { return this->size; }
 
-void* BaseMemory::readData(uint32_t _addr, size_t _size, bool _deep_copy) const {
-	ASSERT_MSG(_addr + _size <= this->getSize(), "The memory region to be accessed is out of range.");
-	if (_deep_copy) {
-		size_t size = sizeof(uint8_t) * _size;
-		void*  data = std::malloc(size);
-		std::memcpy(data, (uint8_t*)this->mem + _addr, size);
-		return data;
-	} else {
-		return (uint8_t*)this->mem + _addr;
-	}
+std::span<const std::byte> BaseMemory::view(uint32_t _addr, size_t _size) const {
+	ASSERT_MSG((size_t)_addr + _size <= this->getSize(), "The memory region to be accessed is out of range.");
+	return {static_cast<const std::byte*>(this->mem) + _addr, _size};
 }
 
-void BaseMemory::writeData(void* _data, uint32_t _addr, size_t _size) {
-	ASSERT_MSG(_data, "The received argument `_data` is a nullptr.");
-	ASSERT_MSG(_addr + _size <= this->getSize(), "The memory region to be accessed is out of range.");
+std::span<std::byte> BaseMemory::view(uint32_t _addr, size_t _size) {
+	ASSERT_MSG((size_t)_addr + _size <= this->getSize(), "The memory region to be accessed is out of range.");
+	return {static_cast<std::byte*>(this->mem) + _addr, _size};
+}
 
-	std::memcpy((uint8_t*)this->mem + _addr, _data, sizeof(uint8_t) * _size);
+void BaseMemory::writeData(const void* _data, uint32_t _addr, size_t _size) {
+	ASSERT_MSG(_data, "The received argument `_data` is a nullptr.");
+	std::memcpy(this->view(_addr, _size).data(), _data, _size);
 }
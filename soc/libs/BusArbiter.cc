@@ -0,0 +1,84 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BusArbiter.hh"
+
+BusArbiter::Policy BusArbiter::parsePolicy(const std::string& _policy) {
+	if (_policy == "round_robin" || _policy == "rr") return Policy::ROUND_ROBIN;
+	if (_policy == "fixed_priority" || _policy == "priority") return Policy::FIXED_PRIORITY;
+	if (_policy == "weighted_round_robin" || _policy == "wrr") return Policy::WEIGHTED_ROUND_ROBIN;
+	if (_policy == "age") return Policy::AGE;
+	ERROR << "BusArbiter: unknown arbitration policy " << _policy;
+	return Policy::ROUND_ROBIN;
+}
+
+const char* BusArbiter::policyName(Policy _policy) {
+	switch (_policy) {
+		case Policy::ROUND_ROBIN: return "round_robin";
+		case Policy::FIXED_PRIORITY: return "fixed_priority";
+		case Policy::WEIGHTED_ROUND_ROBIN: return "weighted_round_robin";
+		case Policy::AGE: return "age";
+	}
+	return "unknown";
+}
+
+size_t BusArbiter::select(std::span<const Request> _heads) {
+	size_t winner = _heads.size();
+	switch (this->policy) {
+		case Policy::ROUND_ROBIN: winner = this->selectRoundRobin(_heads); break;
+		case Policy::WEIGHTED_ROUND_ROBIN: winner = this->selectWeighted(_heads); break;
+		case Policy::FIXED_PRIORITY:
+			for (size_t m = 0; m < _heads.size(); m++) {
+				if (!_heads[m].valid) continue;
+				if (winner == _heads.size() || _heads[m].qos > _heads[winner].qos) winner = m;
+			}
+			break;
+		case Policy::AGE:
+			for (size_t m = 0; m < _heads.size(); m++) {
+				if (!_heads[m].valid) continue;
+				if (winner == _heads.size() || _heads[m].issue < _heads[winner].issue) winner = m;
+			}
+			break;
+	}
+	LABELED_ASSERT(winner < _heads.size(), "BusArbiter::select() called without a pending request");
+	this->last = winner;
+	return winner;
+}
+
+size_t BusArbiter::selectRoundRobin(std::span<const Request> _heads) {
+	for (size_t i = 1; i <= _heads.size(); i++) {
+		size_t m = (this->last + i) % _heads.size();
+		if (_heads[m].valid) return m;
+	}
+	return _heads.size();
+}
+
+size_t BusArbiter::selectWeighted(std::span<const Request> _heads) {
+	if (this->credits.size() != _heads.size()) this->credits.assign(_heads.size(), 0);
+
+	// Start a new round once no requesting master has grants left
+	for (int round = 0; round < 2; round++) {
+		for (size_t i = 1; i <= _heads.size(); i++) {
+			size_t m = (this->last + i) % _heads.size();
+			if (_heads[m].valid && this->credits[m] > 0) {
+				this->credits[m]--;
+				return m;
+			}
+		}
+		for (size_t m = 0; m < _heads.size(); m++) { this->credits[m] = _heads[m].qos + 1u; }
+	}
+	return _heads.size();
+}
@@ -1,11 +1,67 @@
 #include "CFU.hh"
 
+#include <algorithm>
+
 #include "DataStruct.hh"
+#include "SystemConfig.hh"
+#include "event/CFUResultEvent.hh"
 class Controller;
 class AddSubActivationUnit;
 class MulUnit;
 class RegisterUnit;
 
+static const struct {
+	instr_type  op;
+	const char* name;
+} kCfuOps[] = {
+    {S_ADDI8I8S_VV, "saddi8i8s.vv"},         {S_ADDI16I16S_VV, "saddi16i16s.vv"},
+    {S_SUBI8I8S_VV, "ssubi8i8s.vv"},         {S_SUBI16I16S_VV, "ssubi16i16s.vv"},
+    {S_PMULI8I16S_VV_L, "spmuli8i16s.vv.l"}, {S_PMULI8I16S_VV_H, "spmuli8i16s.vv.h"},
+    {S_AMULI8I8S_VV_NQ, "samuli8i8s.vv.nq"}, {S_AMULI8I8S_VV_L, "samuli8i8s.vv.l"},
+    {V_ADDI8I8S_VV, "vsaddi8i8s.vv"},        {V_ADDI16I16S_VV, "vsaddi16i16s.vv"},
+    {V_SUBI8I8S_VV, "vssubi8i8s.vv"},        {V_SUBI16I16S_VV, "vssubi16i16s.vv"},
+    {V_PMULI8I16S_VV_L, "vspmuli8i16s.vv.l"}, {V_PMULI8I16S_VV_H, "vspmuli8i16s.vv.h"},
+    {V_AMULI8I8S_VV_NQ, "vsamuli8i8s.vv.nq"}, {V_AMULI8I8S_VV_L, "vsamuli8i8s.vv.l"},
+    {MAC4, "mac4"},                          {RDACC, "rdacc"},
+};
+
+static_assert(V_AMULI8I8S_VV_L - V_ADDI8I8S_VV == S_AMULI8I8S_VV_L - S_ADDI8I8S_VV,
+              "The vector CFU ops must mirror the order of the scalar ones");
+
+/** @brief The packed op a vector op applies to each 32-bit slice of its registers */
+static instr_type sliceOp(instr_type _op) {
+	if (!isVectorCfuOp(_op)) return _op;
+	return static_cast<instr_type>(_op - V_ADDI8I8S_VV + S_ADDI8I8S_VV);
+}
+
+void CFU::init() {
+	OpTiming def{acalsim::top->getParameter<acalsim::Tick>("CFU", "latency"),
+	             acalsim::top->getParameter<acalsim::Tick>("CFU", "ii")};
+	this->timing.assign(HCF + 1, def);
+	for (const auto& o : acalsim::top->getParameter<std::vector<CFUOpTiming>>("CFU", "ops")) {
+		auto it = std::find_if(std::begin(kCfuOps), std::end(kCfuOps), [&](const auto& _e) { return o.op == _e.name; });
+		if (it == std::end(kCfuOps)) {
+			ERROR << "CFU: unknown op " << o.op << " in the CFU timing table";
+			continue;
+		}
+		if (o.latency >= 0) this->timing[it->op].latency = o.latency;
+		if (o.ii >= 0) this->timing[it->op].ii = o.ii;
+		LABELED_ASSERT(this->timing[it->op].ii > 0, "CFU: the initiation interval must be at least 1");
+	}
+
+	int width = acalsim::top->getParameter<int>("CFU", "issue_width");
+	LABELED_ASSERT(width > 0, "CFU: issue_width must be at least 1");
+	for (auto& lanes : this->laneFree) { lanes.assign(width, 0); }
+}
+
+void CFU::cleanup() {
+	uint64_t ops = this->unitOps[0] + this->unitOps[1];
+	if (ops == 0) return;
+	CLASS_INFO << ops << " ops (" << this->unitOps[static_cast<size_t>(Unit_Decision::AddSub)] << " add/sub, "
+	           << this->unitOps[static_cast<size_t>(Unit_Decision::Mul)] << " mul), " << this->structuralStall
+	           << " ticks waiting for a free pipeline";
+}
+
 void CFU::step() {
 	for (auto s_port : this->s_ports_) {
 		if (s_port.second->isPopValid()) {
@@ -17,25 +73,28 @@ void CFU::step() {
 
 uint32_t CFU::get_result(instr i, uint32_t rs1, uint32_t rs2) {
 	this->controller->send_information_to_unit(i, rs1, rs2);
-	this->mulUnit->computation();
-	this->addSubUnit->computation();
-	Unit_Decision decision = this->controller->outputSel();
-	if (decision == Unit_Decision::AddSub) {
-		return this->addSubUnit->getResult();
-	} else if (decision == Unit_Decision::Mul) {
-		return this->mulUnit->getResult();
-	} else {
-		CLASS_ERROR << "(CFU) No such decision";
+	switch (this->controller->outputSel()) {
+		case Unit_Decision::AddSub: this->addSubUnit->computation(); return this->addSubUnit->getResult();
+		case Unit_Decision::Mul: this->mulUnit->computation(); return this->mulUnit->getResult();
+		default: CLASS_ERROR << "(CFU) No such decision";
 	}
 	return 0;
 }
 
 void Controller::send_information_to_unit(instr i, uint32_t rs1, uint32_t rs2) {
-	static_cast<CFU*>(sim)->addSubUnit->setInstrType(i.op);
-	static_cast<CFU*>(sim)->addSubUnit->setOperands(rs1, rs2);
-	static_cast<CFU*>(sim)->mulUnit->setInstrType(i.op);
-	static_cast<CFU*>(sim)->mulUnit->setOperands(rs1, rs2);
 	this->setInstrType(i.op);
+	// Only the unit whose result is selected is evaluated
+	switch (this->outputSel()) {
+		case Unit_Decision::AddSub:
+			static_cast<CFU*>(sim)->addSubUnit->setInstrType(i.op);
+			static_cast<CFU*>(sim)->addSubUnit->setOperands(rs1, rs2);
+			break;
+		case Unit_Decision::Mul:
+			static_cast<CFU*>(sim)->mulUnit->setInstrType(i.op);
+			static_cast<CFU*>(sim)->mulUnit->setOperands(rs1, rs2);
+			break;
+		default: break;
+	}
 }
 
 Unit_Decision Controller::outputSel() {
@@ -47,110 +106,133 @@ Unit_Decision Controller::outputSel() {
 		case S_PMULI8I16S_VV_L:
 		case S_PMULI8I16S_VV_H:
 		case S_AMULI8I8S_VV_NQ:
-		case S_AMULI8I8S_VV_L: return Unit_Decision::Mul;
+		case S_AMULI8I8S_VV_L:
+		case MAC4:
+		case RDACC: return Unit_Decision::Mul;
 		default: return Unit_Decision::Unknown;
 	}
 }
 
+/*
+ * SWAR lane arithmetic: all lanes of a 32-bit word are added or subtracted with one host operation. The lane MSBs are
+ * masked off so no carry or borrow crosses a lane boundary, then patched back in with an XOR, which gives the same
+ * wrap-around result as per-lane int8_t / int16_t arithmetic.
+ */
+static inline uint32_t swarAdd(uint32_t _a, uint32_t _b, uint32_t _msb) {
+	return ((_a & ~_msb) + (_b & ~_msb)) ^ ((_a ^ _b) & _msb);
+}
+
+static inline uint32_t swarSub(uint32_t _a, uint32_t _b, uint32_t _msb) {
+	return ((_a | _msb) - (_b & ~_msb)) ^ ((_a ^ ~_b) & _msb);
+}
+
+/*
+ * SWAR multiply: two signed byte lanes are multiplied with one 64-bit host multiply. Packing the lanes as
+ * (a_lo + a_hi * 2^16) * (b_lo + b_hi * 2^32) = a_lo*b_lo + a_hi*b_lo * 2^16 + a_lo*b_hi * 2^32 + a_hi*b_hi * 2^48,
+ * where every product fits in 16 signed bits. The low 16 bits hold a_lo*b_lo exactly, and rounding off the 48 bits
+ * below the top field leaves a_hi*b_hi, since the three lower terms add up to less than 2^47 in magnitude.
+ */
+struct LanePair {
+	int32_t lo, hi;  ///< signed 16-bit products of the two lanes
+};
+
+static inline LanePair laneProducts(uint32_t _a, uint32_t _b, int _lo, int _hi) {
+	auto    lane = [](uint32_t _w, int _i) { return static_cast<int64_t>(static_cast<int8_t>(_w >> (_i * 8))); };
+	int64_t a    = lane(_a, _lo) + lane(_a, _hi) * (int64_t{1} << 16);
+	int64_t b    = lane(_b, _lo) + lane(_b, _hi) * (int64_t{1} << 32);
+	int64_t p    = a * b;
+	return {static_cast<int16_t>(p), static_cast<int32_t>((p + (int64_t{1} << 47)) >> 48)};
+}
+
 void AddSubActivationUnit::computation() {
+	constexpr uint32_t kMsb8  = 0x80808080u;
+	constexpr uint32_t kMsb16 = 0x80008000u;
 	switch (this->instr_type) {
-		case S_ADDI8I8S_VV: {
-			this->result = 0;
-			for (int i = 0; i < 4; ++i) {
-				int8_t  b1  = (this->rs1 >> (i * 8)) & 0xFF;
-				int8_t  b2  = (this->rs2 >> (i * 8)) & 0xFF;
-				uint8_t res = static_cast<int8_t>(b1 + b2);
-				this->result |= (res << (i * 8));
-			}
-			break;
-		}
-		case S_ADDI16I16S_VV: {
-			this->result = 0;
-			for (int i = 0; i < 2; ++i) {
-				int16_t  h1  = (this->rs1 >> (i * 16)) & 0xFFFF;
-				int16_t  h2  = (this->rs2 >> (i * 16)) & 0xFFFF;
-				uint16_t res = static_cast<int16_t>(h1 + h2);
-				this->result |= (res << (i * 16));
-			}
-			break;
-		}
-		case S_SUBI8I8S_VV: {
-			this->result = 0;
-			for (int i = 0; i < 4; ++i) {
-				int8_t  b1  = (this->rs1 >> (i * 8)) & 0xFF;
-				int8_t  b2  = (this->rs2 >> (i * 8)) & 0xFF;
-				uint8_t res = static_cast<int8_t>(b1 - b2);
-				this->result |= (res << (i * 8));
-			}
-			break;
-		}
-		case S_SUBI16I16S_VV: {
-			this->result = 0;
-			for (int i = 0; i < 2; ++i) {
-				int16_t  h1  = (this->rs1 >> (i * 16)) & 0xFFFF;
-				int16_t  h2  = (this->rs2 >> (i * 16)) & 0xFFFF;
-				uint16_t res = static_cast<int16_t>(h1 - h2);
-				this->result |= (res << (i * 16));
-			}
-			break;
-		}
+		case S_ADDI8I8S_VV: this->result = swarAdd(this->rs1, this->rs2, kMsb8); break;
+		case S_ADDI16I16S_VV: this->result = swarAdd(this->rs1, this->rs2, kMsb16); break;
+		case S_SUBI8I8S_VV: this->result = swarSub(this->rs1, this->rs2, kMsb8); break;
+		case S_SUBI16I16S_VV: this->result = swarSub(this->rs1, this->rs2, kMsb16); break;
 		default: this->result = 0; break;
 	}
 }
 
 void MulUnit::computation() {
+	uint32_t a = this->rs1, b = this->rs2;
+	// 16-bit lane products zero-extended, packed two per word
+	auto pack16 = [](LanePair _p) { return static_cast<uint16_t>(_p.lo) | static_cast<uint32_t>(_p.hi) << 16; };
 	switch (this->instr_type) {
-		case S_PMULI8I16S_VV_L: {
-			this->result = 0;
-			for (int i = 0; i < 2; ++i) {
-				int8_t  b1  = (this->rs1 >> (i * 8)) & 0xFF;
-				int8_t  b2  = (this->rs2 >> (i * 8)) & 0xFF;
-				int16_t mul = static_cast<int16_t>(b1) * static_cast<int16_t>(b2);
-				this->result |= ((uint16_t)mul << (i * 16));  // LSB 16-bit of each
-			}
+		case S_PMULI8I16S_VV_L:  // 16-bit products of byte lanes 0 and 1
+			this->result = pack16(laneProducts(a, b, 0, 1));
 			break;
-		}
-		case S_PMULI8I16S_VV_H: {
-			this->result = 0;
-			for (int i = 2; i < 4; ++i) {
-				int8_t  b1  = (this->rs1 >> (i * 8)) & 0xFF;
-				int8_t  b2  = (this->rs2 >> (i * 8)) & 0xFF;
-				int16_t mul = static_cast<int16_t>(b1) * static_cast<int16_t>(b2);
-				this->result |= ((uint16_t)mul << ((i - 2) * 16));  // next 2 16-bit segments
-			}
+		case S_PMULI8I16S_VV_H:  // 16-bit products of byte lanes 2 and 3
+			this->result = pack16(laneProducts(a, b, 2, 3));
+			break;
+		case S_AMULI8I8S_VV_NQ: {  // high byte of each 16-bit product
+			uint32_t p01 = pack16(laneProducts(a, b, 0, 1)), p23 = pack16(laneProducts(a, b, 2, 3));
+			this->result = (p01 >> 8 & 0x00FFu) | (p01 >> 16 & 0xFF00u) | (p23 << 8 & 0x00FF0000u) |
+			               (p23 & 0xFF000000u);
 			break;
 		}
-		case S_AMULI8I8S_VV_NQ: {
-			this->result = 0;
-			for (int i = 0; i < 4; ++i) {
-				int8_t  b1  = (this->rs1 >> (i * 8)) & 0xFF;
-				int8_t  b2  = (this->rs2 >> (i * 8)) & 0xFF;
-				int16_t mul = static_cast<int16_t>(b1) * static_cast<int16_t>(b2);
-				uint8_t msb = (mul >> 8) & 0xFF;  // take MSB of the 16-bit product
-				this->result |= (msb << (i * 8));
-			}
+		case S_AMULI8I8S_VV_L: {  // low byte of each 16-bit product
+			uint32_t p01 = pack16(laneProducts(a, b, 0, 1)), p23 = pack16(laneProducts(a, b, 2, 3));
+			this->result = (p01 & 0x00FFu) | (p01 >> 8 & 0xFF00u) | (p23 << 16 & 0x00FF0000u) |
+			               (p23 << 8 & 0xFF000000u);
 			break;
 		}
-		case S_AMULI8I8S_VV_L: {
-			this->result = 0;
-			for (int i = 0; i < 4; ++i) {
-				int8_t  b1  = (this->rs1 >> (i * 8)) & 0xFF;
-				int8_t  b2  = (this->rs2 >> (i * 8)) & 0xFF;
-				int16_t mul = static_cast<int16_t>(b1) * static_cast<int16_t>(b2);
-				uint8_t lsb = mul & 0xFF;  // Take the lower 8 bits
-				this->result |= (lsb << (i * 8));
-			}
+		case MAC4: {  // acc += dot product of the four signed byte lanes
+			LanePair p01 = laneProducts(a, b, 0, 1), p23 = laneProducts(a, b, 2, 3);
+			this->acc += p01.lo + p01.hi + p23.lo + p23.hi;
+			this->result = static_cast<uint32_t>(this->acc);
 			break;
 		}
+		case RDACC:
+			this->result = static_cast<uint32_t>(this->acc);
+			this->acc    = 0;
+			break;
 		default: this->result = 0; break;
 	}
 }
 
 void CFU::packet_handler(CFUReqPacket* _pkt) {
-	auto           rc           = acalsim::top->getRecycleContainer();
-	uint32_t       result       = this->get_result(_pkt->getInstr(), _pkt->getRs1(), _pkt->getRs2());
-	CFURespPacket* cfu_resp_pkt = rc->acquire<CFURespPacket>(&CFURespPacket::renew, _pkt->getInstr(), result);
+	auto           rc = acalsim::top->getRecycleContainer();
+	CFURespPacket* cfu_resp_pkt;
+	if (isVectorCfuOp(_pkt->getInstr().op)) {
+		// A vector op runs the packed op on every 32-bit slice in one pass through the unit's wider datapath
+		instr slice = _pkt->getInstr();
+		slice.op    = sliceOp(slice.op);
+		VReg vd;
+		for (size_t w = 0; w < VREG_WORDS; w++) {
+			vd[w] = this->get_result(slice, _pkt->getVs1()[w], _pkt->getVs2()[w]);
+		}
+		cfu_resp_pkt = rc->acquire<CFURespPacket>(&CFURespPacket::renewVector, _pkt->getInstr(), vd);
+	} else {
+		uint32_t result = this->get_result(_pkt->getInstr(), _pkt->getRs1(), _pkt->getRs2());
+		cfu_resp_pkt    = rc->acquire<CFURespPacket>(&CFURespPacket::renew, _pkt->getInstr(), result);
+	}
+	Unit_Decision    unit   = this->controller->outputSel();
+	const instr_type op     = _pkt->getInstr().op;
+	const OpTiming   timing = this->timing[op];
 	rc->recycle(_pkt);
-	this->pushToMasterChannelPort(this->getName() + "-m_cpu", cfu_resp_pkt);
-	return;
+	if (unit == Unit_Decision::Unknown) return;
+
+	// Start on the pipeline of the unit that frees up first
+	acalsim::Tick now   = acalsim::top->getGlobalTick();
+	auto&         lanes = this->laneFree[static_cast<size_t>(unit)];
+	auto          lane  = std::min_element(lanes.begin(), lanes.end());
+	acalsim::Tick start = std::max(now, *lane);
+	this->structuralStall += start - now;
+	// mac4s chain through the accumulator adder back to back, but rdacc reads it only after the last mac4 added in
+	if (op == RDACC) start = std::max(start, this->accReady);
+	*lane = start + timing.ii;
+	this->unitOps[static_cast<size_t>(unit)]++;
+
+	acalsim::Tick done = start + timing.latency;
+	if (op == MAC4) this->accReady = done;
+	if (done <= now) {
+		this->sendResult(cfu_resp_pkt);
+		return;
+	}
+	this->scheduleEvent(rc->acquire<CFUResultEvent>(&CFUResultEvent::renew, this, cfu_resp_pkt), done);
 }
+
+void CFU::sendResult(CFURespPacket* _pkt) { this->pushToMasterChannelPort(this->cpuPort, _pkt); }
@@ -16,6 +16,7 @@
 
 #include "CPU.hh"
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
@@ -26,6 +27,8 @@
 CPU::CPU(std::string _name, Emulator* _emulator)
     : acalsim::CPPSimBase(_name), pc(0), inst_cnt(0), isaEmulator(_emulator) {
 	this->registerSimPort();
+	this->busHandlers.on<&CPU::memReadXBarRespHandler>();
+	this->busHandlers.on<&CPU::memWriteXBarRespHandler>();
 }
 
 void CPU::init() {
@@ -41,6 +44,27 @@ void CPU::init() {
 		this->imem[i].a3.type = OPTYPE_NONE;
 	}
 	for (int i = 0; i < 32; i++) { this->rf[i] = 0; }
+	this->rf[10] = this->hartID;  // a0 holds the core index at reset, as on a RISC-V boot
+
+	if (acalsim::top->getParameter<int>("L1DCache", "enable")) {
+		this->dcache = std::make_unique<L1DCache>(
+		    this->getName() + "-l1d", acalsim::top->getParameter<int>("L1DCache", "sets"),
+		    acalsim::top->getParameter<int>("L1DCache", "ways"), acalsim::top->getParameter<int>("L1DCache", "line_size"),
+		    acalsim::top->getParameter<acalsim::Tick>("L1DCache", "hit_latency"),
+		    L1DCache::parsePolicy(acalsim::top->getParameter<std::string>("L1DCache", "policy")));
+	}
+
+	int quantum = acalsim::top->getParameter<int>("SOC", "cpu_quantum");
+	LABELED_ASSERT(quantum > 0, "CPU: SOC.cpu_quantum must be at least 1");
+	this->quantum = quantum;
+	int lsq       = acalsim::top->getParameter<int>("SOC", "cpu_load_queue_depth");
+	LABELED_ASSERT(lsq >= 0 && lsq <= 32, "CPU: SOC.cpu_load_queue_depth must be between 0 and 32");
+	this->loadQueueDepth = lsq;
+	int wb               = acalsim::top->getParameter<int>("SOC", "cpu_write_buffer_depth");
+	LABELED_ASSERT(wb >= 0, "CPU: SOC.cpu_write_buffer_depth must not be negative");
+	LABELED_ASSERT(static_cast<size_t>(wb + lsq) <= kMaxOutstanding,
+	               "CPU: cpu_write_buffer_depth + cpu_load_queue_depth must not exceed the outstanding table");
+	this->writeBufferDepth = wb;
 
 	auto               rc    = acalsim::top->getRecycleContainer();
 	ExecOneInstrEvent* event = rc->acquire<ExecOneInstrEvent>(&ExecOneInstrEvent::renew, 1 /*id*/, this);
@@ -49,71 +73,282 @@ void CPU::init() {
 
 void CPU::execOneInstr() {
 	// This lab models a single-CPU cycle as shown in Lab7
-	// Fetch instruction
-	instr i = this->fetchInstr(this->pc);
-	// Execute the instruction in the same cycle
-	processInstr(i);
+	// Fetch the predecoded instruction and execute it in the same cycle
+	// Run ahead of the global tick over instructions that only touch the register file and the PC. A bus or CFU
+	// instruction ends the run and executes in its own event, at the tick it would have had anyway.
+	acalsim::Tick local = 0;
+	while (local < this->quantum) {
+		const Uop& u = this->uops[this->pc / 4];
+		if (!this->canIssue(u)) {
+			if (local > 0) break;
+			// Nothing is scheduled until a bus response wakes the CPU up in resumeIssue()
+			this->issueStalled = true;
+			this->stallStart   = acalsim::top->getGlobalTick();
+			return;
+		}
+		if (u.handler == &CPU::execInstr) {
+			if (local == 0) u.handler(this, u);
+			break;
+		}
+		u.handler(this, u);
+		local++;
+	}
+	if (local > 0) this->scheduleNextInstr(local);
+}
+
+static uint8_t uopReg(const operand& _o) { return static_cast<uint8_t>(_o.reg & 31); }
+
+static uint8_t uopVReg(const operand& _o) { return static_cast<uint8_t>(Uop::kVRegBase + (_o.reg & (NUM_VREGS - 1))); }
+
+void CPU::predecode() {
+	size_t slots = acalsim::top->getParameter<int>("Emulator", "data_offset") / 4;
+	this->uops.assign(slots, Uop{});
+	for (size_t n = 0; n < slots; n++) {
+		const instr& i = this->imem[n];
+		Uop&         u = this->uops[n];
+		u.op           = static_cast<uint8_t>(i.op);
+		u.handler      = uopHandler(i.op);
+		// The parser only fills the operand fields an instruction format uses (and does not always set
+		// `operand::type`), so the fields are picked per format rather than per operand type
+		switch (i.op) {
+			case ADD:
+			case SUB:
+			case MUL:
+			case MULH:
+			case MULHSU:
+			case MULHU:
+			case DIV:
+			case DIVU:
+			case REM:
+			case REMU:
+			case SLT:
+			case SLTU:
+			case AND:
+			case OR:
+			case XOR:
+			case SLL:
+			case SRL:
+			case SRA:
+			case S_ADDI8I8S_VV:
+			case S_ADDI16I16S_VV:
+			case S_SUBI8I8S_VV:
+			case S_SUBI16I16S_VV:
+			case S_PMULI8I16S_VV_L:
+			case S_PMULI8I16S_VV_H:
+			case S_AMULI8I8S_VV_NQ:
+			case S_AMULI8I8S_VV_L:
+			case MAC4:
+			case AMOSWAP_W:
+			case AMOADD_W:
+			case AMOAND_W:
+			case AMOOR_W:
+			case AMOXOR_W:
+			case AMOMIN_W:
+			case AMOMAX_W:
+			case AMOMINU_W:
+			case AMOMAXU_W:
+				u.rd  = uopReg(i.a1);
+				u.rs1 = uopReg(i.a2);
+				u.rs2 = uopReg(i.a3);
+				break;
+			case ADDI:
+			case SLTI:
+			case SLTIU:
+			case ANDI:
+			case ORI:
+			case XORI:
+			case SLLI:
+			case SRLI:
+			case SRAI:
+			case LB:
+			case LBU:
+			case LH:
+			case LHU:
+			case LW:
+			case JALR:
+				u.rd  = uopReg(i.a1);
+				u.rs1 = uopReg(i.a2);
+				u.imm = static_cast<int32_t>(i.a3.imm);
+				break;
+			case SB:
+			case SH:
+			case SW:
+				u.rs1 = uopReg(i.a2);  // base
+				u.rs2 = uopReg(i.a1);  // data
+				u.imm = static_cast<int32_t>(i.a3.imm);
+				break;
+			case BEQ:
+			case BGE:
+			case BGEU:
+			case BLT:
+			case BLTU:
+			case BNE:
+				u.rs1 = uopReg(i.a1);
+				u.rs2 = uopReg(i.a2);
+				u.imm = static_cast<int32_t>(i.a3.imm);
+				break;
+			case RDACC:
+				u.rd = uopReg(i.a1);
+				break;
+			case JAL:
+			case AUIPC:
+			case LUI:
+				u.rd  = uopReg(i.a1);
+				u.imm = static_cast<int32_t>(i.a2.imm);
+				break;
+			case V_ADDI8I8S_VV:
+			case V_ADDI16I16S_VV:
+			case V_SUBI8I8S_VV:
+			case V_SUBI16I16S_VV:
+			case V_PMULI8I16S_VV_L:
+			case V_PMULI8I16S_VV_H:
+			case V_AMULI8I8S_VV_NQ:
+			case V_AMULI8I8S_VV_L:
+				u.rd  = uopVReg(i.a1);
+				u.rs1 = uopVReg(i.a2);
+				u.rs2 = uopVReg(i.a3);
+				break;
+			case VL128:
+				u.rd  = uopVReg(i.a1);
+				u.rs1 = uopReg(i.a2);
+				u.imm = static_cast<int32_t>(i.a3.imm);
+				break;
+			case VS128:
+				u.rs1 = uopReg(i.a2);   // base
+				u.rs2 = uopVReg(i.a1);  // data
+				u.imm = static_cast<int32_t>(i.a3.imm);
+				break;
+			case VMV_V_X:
+				u.rd  = uopVReg(i.a1);
+				u.rs1 = uopReg(i.a2);
+				break;
+			default: break;
+		}
+	}
+}
+
+Uop::Handler CPU::uopHandler(instr_type _op) {
+	switch (_op) {
+		case ADD: return &CPU::execUop<ADD>;
+		case SUB: return &CPU::execUop<SUB>;
+		case MUL: return &CPU::execUop<MUL>;
+		case MULH: return &CPU::execUop<MULH>;
+		case MULHSU: return &CPU::execUop<MULHSU>;
+		case MULHU: return &CPU::execUop<MULHU>;
+		case DIV: return &CPU::execUop<DIV>;
+		case DIVU: return &CPU::execUop<DIVU>;
+		case REM: return &CPU::execUop<REM>;
+		case REMU: return &CPU::execUop<REMU>;
+		case SLT: return &CPU::execUop<SLT>;
+		case SLTU: return &CPU::execUop<SLTU>;
+		case AND: return &CPU::execUop<AND>;
+		case OR: return &CPU::execUop<OR>;
+		case XOR: return &CPU::execUop<XOR>;
+		case SLL: return &CPU::execUop<SLL>;
+		case SRL: return &CPU::execUop<SRL>;
+		case SRA: return &CPU::execUop<SRA>;
+		case ADDI: return &CPU::execUop<ADDI>;
+		case SLTI: return &CPU::execUop<SLTI>;
+		case SLTIU: return &CPU::execUop<SLTIU>;
+		case ANDI: return &CPU::execUop<ANDI>;
+		case ORI: return &CPU::execUop<ORI>;
+		case XORI: return &CPU::execUop<XORI>;
+		case SLLI: return &CPU::execUop<SLLI>;
+		case SRLI: return &CPU::execUop<SRLI>;
+		case SRAI: return &CPU::execUop<SRAI>;
+		case BEQ: return &CPU::execUop<BEQ>;
+		case BGE: return &CPU::execUop<BGE>;
+		case BGEU: return &CPU::execUop<BGEU>;
+		case BLT: return &CPU::execUop<BLT>;
+		case BLTU: return &CPU::execUop<BLTU>;
+		case BNE: return &CPU::execUop<BNE>;
+		case JAL: return &CPU::execUop<JAL>;
+		case JALR: return &CPU::execUop<JALR>;
+		case AUIPC: return &CPU::execUop<AUIPC>;
+		case LUI: return &CPU::execUop<LUI>;
+		// Bus, CFU and unimplemented instructions keep the full `instr` they hand to their packets
+		default: return &CPU::execInstr;
+	}
 }
 
+/** @brief RV32M high multiplies, divides and remainders; division by zero and overflow give the ISA's results */
+static inline uint32_t mulDiv(instr_type _op, uint32_t _a, uint32_t _b) {
+	int32_t a = static_cast<int32_t>(_a), b = static_cast<int32_t>(_b);
+	switch (_op) {
+		case MULH: return static_cast<uint32_t>((int64_t{a} * int64_t{b}) >> 32);
+		case MULHSU: return static_cast<uint32_t>((int64_t{a} * static_cast<int64_t>(_b)) >> 32);
+		case MULHU: return static_cast<uint32_t>((uint64_t{_a} * uint64_t{_b}) >> 32);
+		case DIV:
+			if (b == 0) return UINT32_MAX;
+			if (a == INT32_MIN && b == -1) return _a;
+			return static_cast<uint32_t>(a / b);
+		case DIVU: return _b == 0 ? UINT32_MAX : _a / _b;
+		case REM:
+			if (b == 0) return _a;
+			if (a == INT32_MIN && b == -1) return 0;
+			return static_cast<uint32_t>(a % b);
+		case REMU: return _b == 0 ? _a : _a % _b;
+		default: return 0;
+	}
+}
+
+template <instr_type Op>
+void CPU::execUop(CPU* _cpu, const Uop& _u) {
+	uint32_t* rf      = _cpu->rf;
+	rf[0]             = 0;  // x0 is hardwired; a write to it (e.g. `j`, i.e. jal x0) is discarded here
+	uint32_t  a       = rf[_u.rs1];
+	uint32_t  b       = rf[_u.rs2];
+	uint32_t  imm     = static_cast<uint32_t>(_u.imm);
+	uint32_t  pc_next = _cpu->pc + 4;
+	_cpu->incrementInstCount();
+
+	if constexpr (Op == ADD) rf[_u.rd] = a + b;
+	else if constexpr (Op == SUB) rf[_u.rd] = a - b;
+	else if constexpr (Op == MUL) rf[_u.rd] = a * b;
+	else if constexpr (Op >= MULH && Op <= REMU) rf[_u.rd] = mulDiv(Op, a, b);
+	else if constexpr (Op == SLT) rf[_u.rd] = static_cast<int32_t>(a) < static_cast<int32_t>(b) ? 1 : 0;
+	else if constexpr (Op == SLTU) rf[_u.rd] = a < b ? 1 : 0;
+	else if constexpr (Op == AND) rf[_u.rd] = a & b;
+	else if constexpr (Op == OR) rf[_u.rd] = a | b;
+	else if constexpr (Op == XOR) rf[_u.rd] = a ^ b;
+	else if constexpr (Op == SLL) rf[_u.rd] = a << (b & 31);
+	else if constexpr (Op == SRL) rf[_u.rd] = a >> (b & 31);
+	else if constexpr (Op == SRA) rf[_u.rd] = static_cast<uint32_t>(static_cast<int32_t>(a) >> (b & 31));
+	else if constexpr (Op == ADDI) rf[_u.rd] = a + imm;
+	else if constexpr (Op == SLTI) rf[_u.rd] = static_cast<int32_t>(a) < _u.imm ? 1 : 0;
+	else if constexpr (Op == SLTIU) rf[_u.rd] = a < imm ? 1 : 0;
+	else if constexpr (Op == ANDI) rf[_u.rd] = a & imm;
+	else if constexpr (Op == ORI) rf[_u.rd] = a | imm;
+	else if constexpr (Op == XORI) rf[_u.rd] = a ^ imm;
+	else if constexpr (Op == SLLI) rf[_u.rd] = a << (imm & 31);
+	else if constexpr (Op == SRLI) rf[_u.rd] = a >> (imm & 31);
+	else if constexpr (Op == SRAI) rf[_u.rd] = static_cast<uint32_t>(static_cast<int32_t>(a) >> (imm & 31));
+	else if constexpr (Op == BEQ) pc_next = a == b ? imm : pc_next;
+	else if constexpr (Op == BNE) pc_next = a != b ? imm : pc_next;
+	else if constexpr (Op == BGE) pc_next = static_cast<int32_t>(a) >= static_cast<int32_t>(b) ? imm : pc_next;
+	else if constexpr (Op == BGEU) pc_next = a >= b ? imm : pc_next;
+	else if constexpr (Op == BLT) pc_next = static_cast<int32_t>(a) < static_cast<int32_t>(b) ? imm : pc_next;
+	else if constexpr (Op == BLTU) pc_next = a < b ? imm : pc_next;
+	else if constexpr (Op == JAL) {
+		rf[_u.rd] = pc_next;
+		pc_next   = imm;
+	} else if constexpr (Op == JALR) {
+		rf[_u.rd] = pc_next;
+		pc_next   = a + imm;  // `a` was read before rd is written, so rd == rs1 works
+	} else if constexpr (Op == AUIPC) rf[_u.rd] = _cpu->pc + (imm << 12);
+	else if constexpr (Op == LUI) rf[_u.rd] = imm << 12;
+
+	_cpu->pc = pc_next;
+}
+
+void CPU::execInstr(CPU* _cpu, [[maybe_unused]] const Uop& _u) { _cpu->processInstr(_cpu->imem[_cpu->pc / 4]); }
+
 void CPU::processInstr(const instr& _i) {
-	bool  done   = false;
-	auto& rf_ref = this->rf;
+	bool done   = false;
+	this->rf[0] = 0;  // x0 is hardwired; a write to it by an earlier instruction or response is discarded here
 	this->incrementInstCount();
-	int pc_next = this->pc + 4;
 
 	switch (_i.op) {
-		case ADD: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] + rf_ref[_i.a3.reg]; break;
-		case SUB: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] - rf_ref[_i.a3.reg]; break;
-		case MUL: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] * rf_ref[_i.a3.reg]; break;
-		case SLT: rf_ref[_i.a1.reg] = (*(int32_t*)&rf_ref[_i.a2.reg]) < (*(int32_t*)&rf_ref[_i.a3.reg]) ? 1 : 0; break;
-		case SLTU: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] + rf_ref[_i.a3.reg]; break;
-		case AND: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] & rf_ref[_i.a3.reg]; break;
-		case OR: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] | rf_ref[_i.a3.reg]; break;
-		case XOR: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] ^ rf_ref[_i.a3.reg]; break;
-		case SLL: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] << rf_ref[_i.a3.reg]; break;
-		case SRL: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] >> rf_ref[_i.a3.reg]; break;
-		case SRA: rf_ref[_i.a1.reg] = (*(int32_t*)&rf_ref[_i.a2.reg]) >> rf_ref[_i.a3.reg]; break;
-
-		case ADDI: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] + _i.a3.imm; break;
-		case SLTI: rf_ref[_i.a1.reg] = (*(int32_t*)&rf_ref[_i.a2.reg]) < (*(int32_t*)&(_i.a3.imm)) ? 1 : 0; break;
-		case SLTIU: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] < _i.a3.imm ? 1 : 0; break;
-		case ANDI: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] & _i.a3.imm; break;
-		case ORI: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] | _i.a3.imm; break;
-		case XORI: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] ^ _i.a3.imm; break;
-		case SLLI: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] << _i.a3.imm; break;
-		case SRLI: rf_ref[_i.a1.reg] = rf_ref[_i.a2.reg] >> _i.a3.imm; break;
-		case SRAI: rf_ref[_i.a1.reg] = (*(int32_t*)&rf_ref[_i.a2.reg]) >> _i.a3.imm; break;
-
-		case BEQ:
-			if (rf_ref[_i.a1.reg] == rf_ref[_i.a2.reg]) pc_next = _i.a3.imm;
-			break;
-		case BGE:
-			if (*(int32_t*)&rf_ref[_i.a1.reg] >= *(int32_t*)&rf_ref[_i.a2.reg]) pc_next = _i.a3.imm;
-			break;
-		case BGEU:
-			if (rf_ref[_i.a1.reg] >= rf_ref[_i.a2.reg]) pc_next = _i.a3.imm;
-			break;
-		case BLT:
-			if (*(int32_t*)&rf_ref[_i.a1.reg] < *(int32_t*)&rf_ref[_i.a2.reg]) pc_next = _i.a3.imm;
-			break;
-		case BLTU:
-			if (rf_ref[_i.a1.reg] < rf_ref[_i.a2.reg]) pc_next = _i.a3.imm;
-			break;
-		case BNE:
-			if (rf_ref[_i.a1.reg] != rf_ref[_i.a2.reg]) pc_next = _i.a3.imm;
-			break;
-
-		case JAL:
-			rf_ref[_i.a1.reg] = this->pc + 4;
-			pc_next           = _i.a2.imm;
-			break;
-		case JALR:
-			rf_ref[_i.a1.reg] = this->pc + 4;
-			pc_next           = rf_ref[_i.a2.reg] + _i.a3.imm;
-			break;
-		case AUIPC: rf_ref[_i.a1.reg] = this->pc + (_i.a2.imm << 12); break;
-		case LUI: rf_ref[_i.a1.reg] = (_i.a2.imm << 12); break;
-
 		case LB:
 		case LBU:
 		case LH:
@@ -128,6 +363,19 @@ void CPU::processInstr(const instr& _i) {
 			done = this->BusmemWrite(_i, _i.op, this->rf[_i.a2.reg] + _i.a3.imm, this->rf[_i.a1.reg]);
 			if (!done) return;
 			break;
+		case AMOSWAP_W:
+		case AMOADD_W:
+		case AMOAND_W:
+		case AMOOR_W:
+		case AMOXOR_W:
+		case AMOMIN_W:
+		case AMOMAX_W:
+		case AMOMINU_W:
+		case AMOMAXU_W:
+			done = this->BusAmo(_i, this->rf[_i.a2.reg], this->rf[_i.a3.reg]);
+			if (!done) return;
+			break;
+		case FENCE: break;  // canIssue() held it back until the earlier accesses completed
 		case S_ADDI8I8S_VV:
 		case S_ADDI16I16S_VV:
 		case S_SUBI8I8S_VV:
@@ -135,17 +383,52 @@ void CPU::processInstr(const instr& _i) {
 		case S_PMULI8I16S_VV_L:
 		case S_PMULI8I16S_VV_H:
 		case S_AMULI8I8S_VV_NQ:
-		case S_AMULI8I8S_VV_L: this->CFUReq(_i, this->rf[_i.a2.reg], this->rf[_i.a3.reg]); return;
+		case S_AMULI8I8S_VV_L:
+		case MAC4:   // rd is x0; the result stays in the CFU accumulator
+		case RDACC:  // no source operands
+			this->CFUReq(_i, this->rf[_i.a2.reg], this->rf[_i.a3.reg]);
+			this->pendingCfuOps++;
+			this->pendingRegs |= uint64_t{1} << (_i.a1.reg & 31);
+			break;
+		case VL128:
+			this->vectorUsed = true;
+			done             = this->BusVecLoad(_i, this->rf[_i.a2.reg] + _i.a3.imm);
+			if (!done) return;
+			break;
+		case VS128:
+			this->vectorUsed = true;
+			done             = this->BusVecStore(_i, this->rf[_i.a2.reg] + _i.a3.imm);
+			if (!done) return;
+			break;
+		case VMV_V_X:
+			this->vectorUsed = true;
+			this->vrf[_i.a1.reg].fill(this->rf[_i.a2.reg]);
+			break;
+		case V_ADDI8I8S_VV:
+		case V_ADDI16I16S_VV:
+		case V_SUBI8I8S_VV:
+		case V_SUBI16I16S_VV:
+		case V_PMULI8I16S_VV_L:
+		case V_PMULI8I16S_VV_H:
+		case V_AMULI8I8S_VV_NQ:
+		case V_AMULI8I8S_VV_L:
+			this->vectorUsed = true;
+			this->CFUReq(_i, this->vrf[_i.a2.reg], this->vrf[_i.a3.reg]);
+			this->pendingCfuOps++;
+			this->pendingRegs |= uint64_t{1} << (Uop::kVRegBase + _i.a1.reg);
+			break;
 		case HCF: break;
 		case UNIMPL:
 		default:
 			CLASS_INFO << "Reached an unimplemented instruction!";
-			if (_i.psrc) printf("Instruction: %s\n", _i.psrc);
+			if (_i.src.len) {
+				printf("Instruction: %.*s\n", static_cast<int>(_i.src.len), this->source.data() + _i.src.offset);
+			}
 			break;
 	}
 
 	this->commitInstr(_i);
-	this->pc = pc_next;
+	this->pc += 4;
 }
 
 void CPU::commitInstr(const instr& _i) {
@@ -153,52 +436,307 @@ void CPU::commitInstr(const instr& _i) {
 	           << " is completed at Tick = " << acalsim::top->getGlobalTick() << " | PC = " << this->pc;*/
 
 	if (_i.op == HCF) return;
+	this->scheduleNextInstr();
+}
 
+void CPU::scheduleNextInstr(acalsim::Tick _delay) {
 	// schedule the next trigger event
 	auto               rc = acalsim::top->getRecycleContainer();
 	ExecOneInstrEvent* event =
 	    rc->acquire<ExecOneInstrEvent>(&ExecOneInstrEvent::renew, this->getInstCount() /*id*/, this);
-	this->scheduleEvent(event, acalsim::top->getGlobalTick() + 1);
+	this->scheduleEvent(event, acalsim::top->getGlobalTick() + _delay);
+}
+
+static size_t memAccessBytes(instr_type _op) {
+	switch (_op) {
+		case LB:
+		case LBU:
+		case SB: return 1;
+		case LH:
+		case LHU:
+		case SH: return 2;
+		default: return 4;
+	}
+}
+
+static uint32_t extendLoad(instr_type _op, uint32_t _raw) {
+	switch (_op) {
+		case LB: return static_cast<uint32_t>(static_cast<int8_t>(_raw));
+		case LBU: return _raw & 0xFF;
+		case LH: return static_cast<uint32_t>(static_cast<int16_t>(_raw));
+		case LHU: return _raw & 0xFFFF;
+		default: return _raw;
+	}
 }
 
 bool CPU::BusMemRead(const instr& _i, instr_type _op, uint32_t _addr, operand _a1) {
-	auto rc      = acalsim::top->getRecycleContainer();
-	int  latency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
+	// Only the DataMemory range is cacheable; MMIO always goes to the bus
+	if (this->dcache && this->isDataMemory(_addr)) { return this->dcacheAccess(_i, _op, _addr, _a1, false, 0); }
 
-	auto Pkt = Construct_MemReadpkt_non_burst(_i, _op, _addr, _a1, "cpu");
+	// Device registers are not memory, so only DataMemory loads are forwarded from the write buffer
+	uint32_t data = 0;
+	if (!this->writeBuffer.empty() && this->isDataMemory(_addr) && this->forwardStore(_op, _addr, data)) {
+		this->rf[_a1.reg] = data;
+		this->storesForwarded++;
+		return true;
+	}
+
+	return this->issueBusLoad(_i, _op, _addr, _a1);
+}
 
-	bool is_stalled = this->m_reg->isStalled();
-	if (!dynamic_cast<acalsim::crossbar::CrossBarPacket*>(Pkt)) {
-		CLASS_ERROR << "Failed to convert that into the CrossBarPacket";
+bool CPU::issueBusLoad(const instr& _i, instr_type _op, uint32_t _addr, operand _a1) {
+	this->sendBusRequest(Construct_MemReadpkt_non_burst(_i, _op, _addr, _a1), false);
+	this->loadsIssued++;
+	if (this->loadQueueDepth == 0) return false;
+	this->pendingLoads++;
+	this->pendingRegs |= uint64_t{1} << (_a1.reg & 31);
+	return true;
+}
+
+static bool isLoad(uint8_t _op) {
+	return _op == LB || _op == LBU || _op == LH || _op == LHU || _op == LW || _op == VL128;
+}
+
+static bool isAmo(uint8_t _op) { return _op >= AMOSWAP_W && _op <= AMOMAXU_W; }
+
+bool CPU::canIssue(const Uop& _u) const {
+	// A fence waits until every earlier load, store and AMO of this core has been performed by its slave
+	if (_u.op == FENCE) return this->getOutstanding() == 0 && this->request_queue.empty();
+	if (this->pendingLoads == 0 && this->pendingCfuOps == 0) return true;
+	if (_u.op == HCF) return false;  // drain the loads and CFU ops so the final register file is complete
+	if ((isLoad(_u.op) || isAmo(_u.op)) && this->pendingLoads >= this->loadQueueDepth) return false;
+	// Sources (RAW) and the destination (WAW, a late response must not overwrite a newer value)
+	return (_u.regMask() & this->pendingRegs) == 0;
+}
+
+void CPU::retireLoad(uint8_t _rd) {
+	this->pendingLoads--;
+	this->pendingRegs &= ~(uint64_t{1} << _rd);
+	this->resumeIssue();
+}
+
+void CPU::resumeIssue() {
+	if (!this->issueStalled) return;
+	this->issueStalled = false;
+	this->issueStallTicks += acalsim::top->getGlobalTick() - this->stallStart;
+	this->scheduleNextInstr();
+}
+
+bool CPU::BusAmo(const instr& _i, uint32_t _addr, uint32_t _src) {
+	if (!this->isDataMemory(_addr) || (_addr & 3)) {
+		CLASS_ERROR << "AMO to 0x" << std::hex << _addr << " must be word aligned and target the data memory";
 	}
-	if (!is_stalled && this->m_reg->push(static_cast<acalsim::crossbar::CrossBarPacket*>(Pkt))) {
-		// LABELED_INFO(this->getName()) << "Send a read request to crosssbar";
-		// send packet instead of event trigger
-	} else {
-		this->request_queue.push(Pkt);
+	// AMOs bypass the L1 D-cache and the write buffer and are performed at the memory, after the cached copy of the
+	// line has been written back and dropped. The rs2 value rides along in the immediate of the destination
+	// operand; the old memory value comes back like a load result.
+	if (this->dcache) { this->dcacheRelease(_i, _addr, 4); }
+	operand a1 = _i.a1;
+	a1.imm     = _src;
+	return this->issueBusLoad(_i, _i.op, _addr, a1);
+}
+
+bool CPU::BusVecLoad(const instr& _i, uint32_t _addr) {
+	if (!this->isDataMemory(_addr) || (_addr & 3)) {
+		CLASS_ERROR << "vl128 from 0x" << std::hex << _addr << " must be word aligned and target the data memory";
 	}
-	return false;
+	// Like AMOs, vector accesses bypass the L1 D-cache, behind the write-back of the lines they touch. The
+	// destination register and the beat index ride along in the operand of every beat so the response can be
+	// written back slice by slice.
+	if (this->dcache) { this->dcacheRelease(_i, _addr, VREG_WORDS * 4); }
+	auto                                rc = acalsim::top->getRecycleContainer();
+	std::vector<XBarMemReadReqPayload*> payloads;
+	for (int w = 0; w < VREG_WORDS; w++) {
+		operand beat;
+		beat.reg = _i.a1.reg;
+		beat.imm = w;
+		payloads.push_back(
+		    rc->acquire<XBarMemReadReqPayload>(&XBarMemReadReqPayload::renew, _i, LW, _addr + w * 4, beat));
+	}
+	this->sendBusRequest(Construct_MemReadpkt_burst(payloads), false);
+	this->loadsIssued++;
+	if (this->loadQueueDepth == 0) return false;
+	this->pendingLoads++;
+	this->pendingRegs |= uint64_t{1} << (Uop::kVRegBase + _i.a1.reg);
+	return true;
 }
 
-bool CPU::BusmemWrite(const instr& _i, instr_type _op, uint32_t _addr, uint32_t _data) {
-	auto rc      = acalsim::top->getRecycleContainer();
-	int  latency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_write_latency");
+bool CPU::BusVecStore(const instr& _i, uint32_t _addr) {
+	if (!this->isDataMemory(_addr) || (_addr & 3)) {
+		CLASS_ERROR << "vs128 to 0x" << std::hex << _addr << " must be word aligned and target the data memory";
+	}
+	// The burst queues behind any posted stores but is not posted itself; it retires once the bus accepts it, so
+	// store-to-load forwarding never has to look inside a 16-byte entry. The cached copies of the target lines are
+	// written back and dropped first so the burst lands on current data and is not hidden by a stale line.
+	if (this->dcache) { this->dcacheRelease(_i, _addr, VREG_WORDS * 4); }
+	auto                                 rc  = acalsim::top->getRecycleContainer();
+	const VReg&                          src = this->vrf[_i.a1.reg];
+	std::vector<XBarMemWriteReqPayload*> payloads;
+	for (int w = 0; w < VREG_WORDS; w++) {
+		payloads.push_back(
+		    rc->acquire<XBarMemWriteReqPayload>(&XBarMemWriteReqPayload::renew, _i, SW, _addr + w * 4, src[w]));
+	}
+	return this->sendBusRequest(Construct_MemWritepkt_burst(payloads), true);
+}
 
-	auto Pkt = Construct_MemWritepkt_non_burst(_i, _op, _addr, _data, "cpu");
+bool CPU::BusmemWrite(const instr& _i, instr_type _op, uint32_t _addr, uint32_t _data) {
+	if (this->dcache && this->isDataMemory(_addr)) {
+		return this->dcacheAccess(_i, _op, _addr, _i.a1, true, _data);
+	}
 
-	bool is_stalled = this->m_reg->isStalled();
-	if (!dynamic_cast<acalsim::crossbar::CrossBarPacket*>(Pkt)) {
-		CLASS_ERROR << "Failed to convert that into the CrossBarPacket";
+	auto Pkt = Construct_MemWritepkt_non_burst(_i, _op, _addr, _data);
+	if (this->writeBufferDepth == 0) {
+		if (this->sendBusRequest(Pkt, true)) {
+			LABELED_INFO(this->getName()) << "Send a write request to bus";
+			return true;
+		}
+		return false;
 	}
-	if (!is_stalled && this->m_reg->push(Pkt)) {
-		LABELED_INFO(this->getName()) << "Send a write request to bus";
+
+	// Posted store: retire now and let the buffer drain to the bus behind the earlier requests
+	if (this->sendBusRequest(Pkt, false)) return true;
+	this->request_queue.back().buffered = true;
+	this->writeBuffer.push_back({_addr, static_cast<uint32_t>(memAccessBytes(_op)), _data});
+	if (this->writeBuffer.size() <= this->writeBufferDepth) return true;
+
+	// The buffer overflowed: the store keeps its slot, but the CPU waits until an older entry drains
+	this->storeStalled    = true;
+	this->storeStallInstr = _i;
+	this->stallStart      = acalsim::top->getGlobalTick();
+	return false;
+}
+
+bool CPU::forwardStore(instr_type _op, uint32_t _addr, uint32_t& _data) const {
+	uint32_t bytes = memAccessBytes(_op);
+	for (auto it = this->writeBuffer.rbegin(); it != this->writeBuffer.rend(); ++it) {
+		if (_addr + bytes <= it->addr || it->addr + it->bytes <= _addr) continue;
+		// The youngest overlapping store decides: forward it if it covers the whole load, otherwise the load
+		// has to see the merged bytes in memory and goes to the bus behind the store
+		if (_addr < it->addr || _addr + bytes > it->addr + it->bytes) return false;
+		_data = extendLoad(_op, it->data >> ((_addr - it->addr) * 8));
 		return true;
-	} else {
-		this->request_queue.push(Pkt);
 	}
 	return false;
 }
 
+bool CPU::sendBusRequest(XBarPacket* _pkt, bool _commit_on_accept, bool _fill) {
+	// Keep the issue order: nothing may overtake a request that is already waiting
+	if (this->request_queue.empty() && this->pushBusRequest(_pkt, _fill)) { return true; }
+	this->request_queue.push({_pkt, _commit_on_accept, false, _fill});
+	return false;
+}
+
+bool CPU::pushBusRequest(XBarPacket* _pkt, bool _fill) {
+	if (!this->pushRequest(this->m_reg, _pkt)) return false;
+	if (_fill) { this->dcacheFillTids.push_back(_pkt->getAutoIncTID()); }
+	return true;
+}
+
+
+// Line transfers are split into bursts of at most four beats
+static int lineChunkWords(int _left) { return _left >= 4 ? 4 : (_left >= 2 ? 2 : 1); }
+
+bool CPU::dcacheAccess(const instr& _i, instr_type _op, uint32_t _addr, operand _a1, bool _is_store, uint32_t _data) {
+	size_t bytes = memAccessBytes(_op);
+
+	// An access crossing a line boundary is not cacheable; it goes to the memory directly, queued behind the
+	// write-back of the lines it touches so that it neither reads stale data nor gets overwritten by a later eviction
+	if (this->dcache->lineBase(_addr) != this->dcache->lineBase(_addr + bytes - 1)) {
+		this->dcacheRelease(_i, _addr, bytes);
+		if (_is_store) {
+			return this->sendBusRequest(Construct_MemWritepkt_non_burst(_i, _op, _addr, _data), true);
+		}
+		return this->issueBusLoad(_i, _op, _addr, _a1);
+	}
+
+	if (this->dcache->access(_addr, _is_store)) {
+		this->dcacheComplete(_op, _addr, _a1, _data);
+		acalsim::Tick latency = this->dcache->getHitLatency();
+		if (latency <= 1) return true;
+
+		// Retire here and start the next instruction `latency` ticks later instead of the usual one
+		this->pc += 4;
+		this->scheduleNextInstr(latency);
+		return false;
+	}
+
+	// Miss: write back the victim if it is dirty, then fetch the whole line (write-allocate)
+	this->dcacheMiss = DCacheMiss{_i, _op, _addr, _a1, _data};
+
+	auto             rc         = acalsim::top->getRecycleContainer();
+	int              wordsTotal = this->dcache->getWordsPerLine();
+	L1DCache::Victim victim     = this->dcache->beginMiss(_addr);
+	uint32_t         lineAddr   = this->dcache->lineBase(_addr);
+
+	if (victim.writeback) { this->dcacheWriteBack(_i, victim); }
+
+	this->dcacheFillTids.clear();
+	for (int w = 0; w < wordsTotal;) {
+		int                                 n = lineChunkWords(wordsTotal - w);
+		std::vector<XBarMemReadReqPayload*> payloads;
+		for (int k = 0; k < n; k++, w++) {
+			operand word;
+			word.reg = 0;
+			word.imm = w;  // the word index rides along and comes back in the response
+			payloads.push_back(
+			    rc->acquire<XBarMemReadReqPayload>(&XBarMemReadReqPayload::renew, _i, LW, lineAddr + w * 4, word));
+		}
+		this->sendBusRequest(Construct_MemReadpkt_burst(payloads), false, true);
+	}
+	return false;
+}
+
+void CPU::dcacheWriteBack(const instr& _i, const L1DCache::Victim& _victim) {
+	auto rc         = acalsim::top->getRecycleContainer();
+	int  wordsTotal = static_cast<int>(_victim.words.size());
+	for (int w = 0; w < wordsTotal;) {
+		int                                  n = lineChunkWords(wordsTotal - w);
+		std::vector<XBarMemWriteReqPayload*> payloads;
+		for (int k = 0; k < n; k++, w++) {
+			payloads.push_back(rc->acquire<XBarMemWriteReqPayload>(&XBarMemWriteReqPayload::renew, _i, SW,
+			                                                       _victim.lineAddr + w * 4, _victim.words[w]));
+		}
+		this->sendBusRequest(Construct_MemWritepkt_burst(payloads), false);
+	}
+}
+
+void CPU::dcacheRelease(const instr& _i, uint32_t _addr, size_t _bytes) {
+	uint32_t last = this->dcache->lineBase(_addr + _bytes - 1);
+	for (uint32_t line = this->dcache->lineBase(_addr);; line += this->dcache->getLineSize()) {
+		L1DCache::Victim victim = this->dcache->invalidate(line);
+		if (victim.writeback) { this->dcacheWriteBack(_i, victim); }
+		if (line == last) break;
+	}
+}
+
+void CPU::dcacheComplete(instr_type _op, uint32_t _addr, operand _a1, uint32_t _data) {
+	size_t bytes = memAccessBytes(_op);
+	switch (_op) {
+		case SB:
+		case SH:
+		case SW: this->dcache->write(_addr, bytes, _data); return;
+		default: break;
+	}
+
+	this->rf[_a1.reg] = extendLoad(_op, this->dcache->read(_addr, bytes));
+}
+
+void CPU::dcacheFillHandler(XBarMemReadRespPacket* _pkt) {
+	auto rc   = acalsim::top->getRecycleContainer();
+	bool done = false;
+	for (auto* beat : _pkt->getPayloads()) {
+		done |= this->dcache->fillWord(beat->getA1().imm, beat->getData());
+		rc->recycle(beat);
+	}
+	rc->recycle(_pkt);
+	if (!done) return;
+
+	this->dcacheFillTids.clear();
+	const DCacheMiss& miss = this->dcacheMiss;
+	this->dcacheComplete(miss.op, miss.addr, miss.a1, miss.data);
+	commitInstr(miss.i);
+	this->pc += 4;
+}
+
 /*  CFU extension*/
 void CPU::CFUReq(const instr& _i, uint32_t _rs1, uint32_t _rs2) {
 	auto          rc      = acalsim::top->getRecycleContainer();
@@ -207,45 +745,103 @@ void CPU::CFUReq(const instr& _i, uint32_t _rs1, uint32_t _rs2) {
 	return;
 }
 
+void CPU::CFUReq(const instr& _i, const VReg& _vs1, const VReg& _vs2) {
+	auto          rc      = acalsim::top->getRecycleContainer();
+	CFUReqPacket* cfu_pkt = rc->acquire<CFUReqPacket>(&CFUReqPacket::renewVector, _i, _vs1, _vs2);
+	this->pushToMasterChannelPort(this->getName() + "-m_cfu", cfu_pkt);
+}
+
 void CPU::CFURespHandler(CFURespPacket* _pkt) {
-	this->rf[_pkt->getInstr().a1.reg] = _pkt->getRd();
-	commitInstr(_pkt->getInstr());
+	uint8_t rd = _pkt->getInstr().a1.reg & 31;
+	if (isVectorCfuOp(_pkt->getInstr().op)) {
+		this->vrf[rd] = _pkt->getVd();
+		rd += Uop::kVRegBase;
+	} else {
+		this->rf[rd] = _pkt->getRd();
+	}
+	// The CFU op retired at issue; only the scoreboard is waiting for its result
+	this->pendingCfuOps--;
+	this->pendingRegs &= ~(uint64_t{1} << rd);
 	acalsim::top->getRecycleContainer()->recycle(_pkt);
-	this->pc += 4;
-	return;
+	this->resumeIssue();
 }
 
 void CPU::masterPortRetry(const std::string& portName) {
-	bool is_stalled = this->m_reg->isStalled();
-	if (!is_stalled) {
+	// Also called when a response frees an outstanding slot while the port itself is idle
+	while (!this->request_queue.empty() && !this->m_reg->isStalled() && this->canIssueTransaction()) {
 		LABELED_INFO(this->getName()) << " send to the port";
-		if (auto read_req = dynamic_cast<XBarMemReadReqPacket*>(this->request_queue.front())) {
-			if (this->m_reg->push(read_req)) { this->request_queue.pop(); }
-		} else if (auto write_req = dynamic_cast<XBarMemWriteReqPacket*>(this->request_queue.front())) {
-			auto real_req = write_req->getPayloads()[0];
-			if (this->m_reg->push(write_req)) {
-				pc += 4;
-				commitInstr(real_req->getInstr());
+		BusRequest req = this->request_queue.front();
+		switch (req.pkt->getKind()) {
+			case PacketKind::MEM_READ_REQ:
+				if (!this->pushBusRequest(req.pkt, req.fill)) return;
+				this->request_queue.pop();
+				break;
+			case PacketKind::MEM_WRITE_REQ: {
+				instr real_instr = static_cast<XBarMemWriteReqPacket*>(req.pkt)->getPayloads()[0]->getInstr();
+				if (!this->pushRequest(this->m_reg, req.pkt)) return;
+				this->request_queue.pop();
+				if (req.commitOnAccept) {
+					pc += 4;
+					commitInstr(real_instr);
+				}
+				if (req.buffered) {
+					this->writeBuffer.pop_front();
+					if (this->storeStalled && this->writeBuffer.size() <= this->writeBufferDepth) {
+						this->storeStalled = false;
+						this->writeBufferStallTicks += acalsim::top->getGlobalTick() - this->stallStart;
+						pc += 4;
+						commitInstr(this->storeStallInstr);
+					}
+				}
+				break;
 			}
-		} else {
-			CLASS_ERROR << "Unexpected type";
+			default:
+				CLASS_ERROR << "Unexpected type";
+				return;
 		}
 	}
 }
 
 void CPU::memReadXBarRespHandler(XBarMemReadRespPacket* _pkt) {
+	if (std::find(this->dcacheFillTids.begin(), this->dcacheFillTids.end(), _pkt->getAutoIncTID()) !=
+	    this->dcacheFillTids.end()) {
+		this->dcacheFillHandler(_pkt);
+		return;
+	}
+	if (_pkt->getPayloads()[0]->getInstr().op == VL128) {
+		this->vecLoadRespHandler(_pkt);
+		return;
+	}
 	auto memPackets = _pkt->getPayloads();
 	for (auto& memPkt : memPackets) { this->memReadRespHandler(memPkt); }
 	int tid = _pkt->getAutoIncTID();
 	acalsim::top->getRecycleContainer()->recycle(_pkt);
 }
 
+void CPU::vecLoadRespHandler(XBarMemReadRespPacket* _pkt) {
+	auto  rc = acalsim::top->getRecycleContainer();
+	instr i  = _pkt->getPayloads()[0]->getInstr();
+	for (auto* beat : _pkt->getPayloads()) {
+		this->vrf[beat->getA1().reg][beat->getA1().imm] = beat->getData();
+		rc->recycle(beat);
+	}
+	rc->recycle(_pkt);
+	if (this->loadQueueDepth > 0) {
+		this->retireLoad(Uop::kVRegBase + i.a1.reg);
+		return;
+	}
+	commitInstr(i);
+	this->pc += 4;
+}
+
 void CPU::memWriteXBarRespHandler(XBarMemWriteRespPacket* _pkt) {
 	// LABELED_INFO(this->getName()) << "CPU finish write transaction" << _pkt->getAutoIncTID();
 	auto memPackets = _pkt->getPayloads();
 	int  tid        = _pkt->getAutoIncTID();
 	for (auto* payload : memPackets) { acalsim::top->getRecycleContainer()->recycle(payload); }
 	acalsim::top->getRecycleContainer()->recycle(_pkt);
+	// A fence may have been waiting for this store
+	this->resumeIssue();
 }
 
 void CPU::memReadRespHandler(XBarMemReadRespPayload* _pkt) {
@@ -254,6 +850,12 @@ void CPU::memReadRespHandler(XBarMemReadRespPayload* _pkt) {
 	instr    i       = _pkt->getInstr();
 	operand  a1      = _pkt->getA1();
 	this->rf[a1.reg] = data;
+	if (this->loadQueueDepth > 0) {
+		// The load already retired at issue; only the scoreboard is waiting for it
+		this->retireLoad(a1.reg);
+		acalsim::top->getRecycleContainer()->recycle(_pkt);
+		return;
+	}
 	// acalsim::top->getRecycleContainer()->recycle(_pkt);
 	commitInstr(i);
 	this->pc += 4;
@@ -283,12 +885,28 @@ void CPU::printRegfile() const {
 
 	oss << '\n';
 
+	if (this->vectorUsed) {
+		for (int v = 0; v < NUM_VREGS; v++) {
+			oss << "v" << std::dec << v << ":0x";
+			// Most significant slice first, so the register reads as one 128-bit number
+			for (int w = VREG_WORDS - 1; w >= 0; w--) {
+				oss << std::setw(8) << std::setfill('0') << std::hex << this->vrf[v][w];
+			}
+			oss << ((v + 1) % 2 == 0 ? "\n" : " ");
+		}
+		oss << '\n';
+	}
+
 	CLASS_INFO << oss.str();
 }
 
-void CPU::dumpMemory() {
+DataMemory* CPU::getDataMemory() {
 	acalsim::crossbar::CrossBar* Xbar = dynamic_cast<acalsim::crossbar::CrossBar*>(this->getDownStream("DSBus"));
-	DataMemory*                  dm   = dynamic_cast<DataMemory*>(Xbar->getDownStream("DSDMem"));
+	return dynamic_cast<DataMemory*>(Xbar->getDownStream("DSDMem"));
+}
+
+void CPU::dumpMemory() {
+	DataMemory* dm = this->getDataMemory();
 	// Open output file
 	std::ofstream outFile("memory_dump.txt");
 	if (!outFile) {
@@ -301,11 +919,10 @@ void CPU::dumpMemory() {
 	uint32_t END_ADDR   = 0xEFFF;
 
 	for (uint32_t addr = START_ADDR; addr <= END_ADDR; addr += 8) {
-		void*    data  = dm->readData(addr, 8, false);
-		uint8_t* bytes = static_cast<uint8_t*>(data);
+		auto bytes = dm->view(addr, 8);
 		// outFile << std::hex << std::setw(4) << std::setfill('0') << addr << ": ";
-		for (size_t i = 0; i < 8; ++i) {
-			outFile << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(bytes[i]) << "\n";
+		for (std::byte b : bytes) {
+			outFile << std::hex << std::setw(2) << std::setfill('0') << std::to_integer<int>(b) << "\n";
 		}
 	}
 
@@ -334,6 +951,16 @@ std::string CPU::instrToString(instr_type _op) const {
 		case SLT: return "SLT";
 		case SLTU: return "SLTU";
 
+		// M extension
+		case MUL: return "MUL";
+		case MULH: return "MULH";
+		case MULHSU: return "MULHSU";
+		case MULHU: return "MULHU";
+		case DIV: return "DIV";
+		case DIVU: return "DIVU";
+		case REM: return "REM";
+		case REMU: return "REMU";
+
 		// I-type
 		case ADDI: return "ADDI";
 		case ANDI: return "ANDI";
@@ -383,6 +1010,35 @@ std::string CPU::instrToString(instr_type _op) const {
 		case S_AMULI8I8S_VV_NQ: return "S_AMULI8I8S.vv.NQ";
 		case S_AMULI8I8S_VV_L: return "S_AMULI8I8S.vv.L";
 
+		// Atomics
+		case AMOSWAP_W: return "AMOSWAP.W";
+		case AMOADD_W: return "AMOADD.W";
+		case AMOAND_W: return "AMOAND.W";
+		case AMOOR_W: return "AMOOR.W";
+		case AMOXOR_W: return "AMOXOR.W";
+		case AMOMIN_W: return "AMOMIN.W";
+		case AMOMAX_W: return "AMOMAX.W";
+		case AMOMINU_W: return "AMOMINU.W";
+		case AMOMAXU_W: return "AMOMAXU.W";
+		case FENCE: return "FENCE";
+
+		// Vector extension
+		case VL128: return "VL128";
+		case VS128: return "VS128";
+		case VMV_V_X: return "VMV.V.X";
+		case V_ADDI8I8S_VV: return "VS_ADDI8I8S.vv";
+		case V_ADDI16I16S_VV: return "VS_ADDI16I16S.vv";
+		case V_SUBI8I8S_VV: return "VS_SUBI8I8S.vv";
+		case V_SUBI16I16S_VV: return "VS_SUBI16I16S.vv";
+		case V_PMULI8I16S_VV_L: return "VS_PMULI8I16S.vv.L";
+		case V_PMULI8I16S_VV_H: return "VS_PMULI8I16S.vv.H";
+		case V_AMULI8I8S_VV_NQ: return "VS_AMULI8I8S.vv.NQ";
+		case V_AMULI8I8S_VV_L: return "VS_AMULI8I8S.vv.L";
+
+		// MAC extension
+		case MAC4: return "MAC4";
+		case RDACC: return "RDACC";
+
 		// Special
 		case HCF: return "HCF";
 
@@ -392,7 +1048,24 @@ std::string CPU::instrToString(instr_type _op) const {
 
 void CPU::cleanup() {
 	LABELED_ASSERT(this->request_queue.empty(), "The request queue should be empty");
+	LABELED_ASSERT(this->pendingLoads == 0, "Every non-blocking load should have been written back");
+	LABELED_ASSERT(this->pendingCfuOps == 0, "Every CFU result should have been written back");
+	this->rf[0] = 0;
 	this->printRegfile();
+	if (this->loadQueueDepth > 0) {
+		CLASS_INFO << this->loadsIssued << " bus loads, " << this->issueStallTicks
+		           << " ticks stalled waiting for load data, CFU results or a fence (load queue depth "
+		           << this->loadQueueDepth << ")";
+	}
+	if (this->writeBufferDepth > 0) {
+		CLASS_INFO << this->storesForwarded << " loads forwarded from the write buffer, " << this->writeBufferStallTicks
+		           << " ticks stalled on a full write buffer (depth " << this->writeBufferDepth << ")";
+	}
+	if (this->dcache) {
+		// Dirty lines only live in the cache; make the memory image complete before dumping it
+		this->dcache->flush(this->getDataMemory());
+		this->dcache->printStats();
+	}
 	this->dumpMemory();
 	CLASS_INFO << "CPU::cleanup() ";
 }
\ No newline at end of file
@@ -43,12 +43,11 @@ void DMAController::readMMIO(acalsim::Tick _when, XBarMemReadReqPayload* _memReq
 	respPkt->setTid(_memReqPkt->getTid());
 
 	std::vector<XBarMemReadRespPayload*> beats   = {respPkt};
-	auto                                 respPtr = Construct_MemReadRespPkt(beats, "dma", _memReqPkt->getCaller());
-	if (_memReqPkt->getCaller() != "cpu" && _memReqPkt->getCaller() != "sa") {
-		CLASS_ERROR << "DMA receive request from " << _memReqPkt->getCaller();
+	auto                                 respPtr = Construct_MemReadRespPkt(beats, _memReqPkt->getMaster());
+	if (_memReqPkt->getMaster() == this->getMasterID()) {
+		CLASS_ERROR << "DMA receive request from " << MasterRegistry::nameOf(_memReqPkt->getMaster());
 	}
-	LABELED_ASSERT(_memReqPkt->getCaller() == "cpu" || _memReqPkt->getCaller() == "sa",
-	               "Should only be programmed by Systolic array or CPU");
+	LABELED_ASSERT(_memReqPkt->getMaster() != this->getMasterID(), "Should only be programmed by Systolic array or CPU");
 	resp_Q.push(respPtr);
 	rc->recycle(_memReqPkt);
 }
@@ -91,10 +90,9 @@ void DMAController::writeMMIO(acalsim::Tick _when, XBarMemWriteReqPayload* _memR
 	respPkt->setTid(_memReqPkt->getTid());
 
 	std::vector<XBarMemWriteRespPayload*> beats   = {respPkt};
-	auto                                  respPtr = Construct_MemWriteRespPkt(beats, "dma", _memReqPkt->getCaller());
+	auto                                  respPtr = Construct_MemWriteRespPkt(beats, _memReqPkt->getMaster());
 	// for the first part the caller can only be cpu
-	LABELED_ASSERT(_memReqPkt->getCaller() == "cpu" || _memReqPkt->getCaller() == "sa",
-	               "Should only be programmed by Systolic array or CPU");
+	LABELED_ASSERT(_memReqPkt->getMaster() != this->getMasterID(), "Should only be programmed by Systolic array or CPU");
 	resp_Q.push(respPtr);
 	rc->recycle(_memReqPkt);
 }
@@ -210,35 +208,61 @@ void DMAController::scheduleReadsForBuffer() {
 
 	// LABELED_INFO(this->getName()) << "Scheduling " << chunk << " package size " << readRequests.size();
 	// Wrap them in a single BusMemReadReqPacket
-	auto XbarPkt = Construct_MemReadpkt_burst("dma", readRequests);
-	int  tid     = XbarPkt->getAutoIncTID();
-	XbarPkt->setTID(tid);
+	auto XbarPkt = Construct_MemReadpkt_burst(readRequests);
 
 	/* LABELED_INFO(this->getName()) << "Starting DMA read datamem to the bufferMemory " << startIndex << " to "
 	                              << startIndex + chunk - 1 << " with transaction id " << tid;*/
 
-	if (!m_req->isStalled() && m_req->push(XbarPkt)) {
+	if (this->req_Q.empty() && this->pushRequest(m_req, XbarPkt)) {
 		// good
 	} else {
 		this->req_Q.push(XbarPkt);
 	}
-	// Keep track of how many read bursts are in flight (usually 1 in this approach)
-	this->pendingBusReadResponses = 1;
 }
 
 /**
  * Once the entire burst completes, the bus calls this method.
  */
+void DMAController::handleReadRequest(XBarMemReadReqPacket* pkt) {
+	int delay_lentency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
+	assert(pkt->getPayloads().size() == pkt->getBurstSize() && pkt->getBurstSize() == 1);
+	// the packet is recycled below; keep the payload pointer only
+	XBarMemReadReqPayload*        payload = pkt->getPayloads()[0];
+	acalsim::LambdaEvent<void()>* event =
+	    new acalsim::LambdaEvent<void()>([this, payload, delay_lentency]() {
+		    this->readMMIO(acalsim::top->getGlobalTick() + delay_lentency, payload);
+	    });
+	this->scheduleEvent(event, acalsim::top->getGlobalTick() + delay_lentency);
+
+	// expect to get the response at
+	acalsim::LambdaEvent<void()>* event_send_req =
+	    new acalsim::LambdaEvent<void()>([this]() { this->trySendPacket(); });
+	this->scheduleEvent(event_send_req, acalsim::top->getGlobalTick() + 1 + delay_lentency);
+	acalsim::top->getRecycleContainer()->recycle(pkt);
+}
+
+void DMAController::handleWriteRequest(XBarMemWriteReqPacket* pkt) {
+	int delay_lentency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
+	assert(pkt->getPayloads().size() == pkt->getBurstSize() && pkt->getBurstSize() == 1);
+	auto payload = pkt->getPayloads();
+	this->writeMMIO(acalsim::top->getGlobalTick(), payload[0]);
+	// expect to get the response at
+	acalsim::LambdaEvent<void()>* event = new acalsim::LambdaEvent<void()>([this]() { this->trySendPacket(); });
+	this->scheduleEvent(event, acalsim::top->getGlobalTick() + 1 + delay_lentency);
+	acalsim::top->getRecycleContainer()->recycle(pkt);
+}
+
 void DMAController::handleReadResponse(XBarMemReadRespPacket* pkt) {
 	// LABELED_INFO(this->getName()) << " receive resp and write to the bufferMemory for tid: " <<
-	auto rc            = acalsim::top->getRecycleContainer();
-	auto readResponses = pkt->getPayloads();
+	auto   rc            = acalsim::top->getRecycleContainer();
+	auto   readResponses = pkt->getPayloads();
+	size_t chunk         = readResponses.size();  // the view dies with the packet
 
 	// Insert data into bufferMemory
 	for (auto* rresp : readResponses) {
 		size_t localIndex = rresp->getA1().imm;  // the operand we stored in scheduleReadsForBuffer
 		if (localIndex < BUFFER_CAPACITY) {
-			this->bufferMemory[localIndex] = rresp->getData();
+			this->bufferMemory.store<uint32_t>(localIndex * sizeof(uint32_t), rresp->getData());
 		} else {
 			LABELED_ERROR(this->getName()) << "Invalid local index in handleReadResponse!";
 		}
@@ -247,12 +271,9 @@ void DMAController::handleReadResponse(XBarMemReadRespPacket* pkt) {
 
 	int tid = pkt->getAutoIncTID();
 
-	// We scheduled only 1 BusMemReadReqPacket, so decrement
-	this->pendingBusReadResponses--;
 	rc->recycle(pkt);
 
 	// Now that this burst is done, we know how many words we consumed
-	size_t chunk = readResponses.size();
 	this->bufferIndex += chunk;
 	this->wordsToBuffer += chunk;  // total in the entire transfer
 
@@ -295,9 +316,8 @@ void DMAController::scheduleWritesFromBuffer() {
 
 	auto rc = acalsim::top->getRecycleContainer();
 
-	size_t wordsToWrite            = bufferIndex;
-	size_t burst_size_words        = (size_t)std::pow(2, this->max_burst_len);  // e.g. 4 => 16 bytes
-	this->pendingBusWriteResponses = 0;
+	size_t wordsToWrite     = bufferIndex;
+	size_t burst_size_words = (size_t)std::pow(2, this->max_burst_len);  // e.g. 4 => 16 bytes
 
 	size_t offset       = 0;
 	size_t chunkCounter = 0;  // We'll increment this for each burst, so each is scheduled 1 cycle apart
@@ -312,16 +332,12 @@ void DMAController::scheduleWritesFromBuffer() {
 
 		createWriteRequestsForChunk(offset, chunk, writeRequests);
 
-		auto XbarWriteReq = Construct_MemWritepkt_burst("dma", writeRequests);
-
-		int tid = XbarWriteReq->getAutoIncTID();
-		XbarWriteReq->setTID(tid);
+		auto XbarWriteReq = Construct_MemWritepkt_burst(writeRequests);
 
-		if (!m_req->isStalled() && m_req->push(XbarWriteReq)) {
+		if (this->req_Q.empty() && this->pushRequest(m_req, XbarWriteReq)) {
 			// success
 		} else {
 			this->req_Q.push(XbarWriteReq);
-			this->pendingBusWriteResponses++;
 		}
 
 		offset += chunk;
@@ -412,7 +428,7 @@ void DMAController::createWriteRequestsForChunk(size_t offset, size_t finalChunk
 
 		uint32_t baseAddr = dstAddr + row * this->Dest_stride + (col * 4);
 		// LABELED_INFO(this->getName()) << "Base address" << std::hex << dstAddr;
-		uint32_t data = bufferMemory[offset + i];
+		uint32_t data = bufferMemory.load<uint32_t>((offset + i) * sizeof(uint32_t));
 
 		// Check partial
 		if (col == ((this->true_width + 3) / 4) && this->true_width % 4 != 0) {
@@ -490,12 +506,12 @@ void DMAController::handleWriteCompletion(XBarMemWriteRespPacket* pkt) {
 	for (auto* payload : pkt->getPayloads()) { rc->recycle(payload); }
 	rc->recycle(pkt);
 
-	this->pendingBusWriteResponses--;
-	// CLASS_INFO << "Pending Write Response :" <<  this->pendingBusWriteResponses;
-	if (this->pendingBusWriteResponses == 0) {
+	// Bursts may complete in any order; the buffer is free once no write of this master is outstanding or queued
+	if (this->getOutstanding(PacketKind::MEM_WRITE_REQ) == 0 && this->req_Q.empty()) {
 		// All writes for this buffer are done
 		// Clear buffer
-		for (size_t i = 0; i < bufferIndex; i++) { bufferMemory[i] = 0; }
+		auto used = bufferMemory.view(0, bufferIndex * sizeof(uint32_t));
+		std::fill(used.begin(), used.end(), std::byte{0});
 		bufferIndex = 0;
 
 		// If we have transferred all data
@@ -523,7 +539,7 @@ void DMAController::printBufferMem() const {
 	for (int i = 0; i < 256; i++) {
 		oss << "x" << std::setw(2) << std::setfill('0') << std::dec << i << ":0x";
 
-		oss << std::setw(8) << std::setfill('0') << std::hex << bufferMemory[i] << " ";
+		oss << std::setw(8) << std::setfill('0') << std::hex << bufferMemory.load<uint32_t>(i * sizeof(uint32_t)) << " ";
 
 		if ((i + 1) % 8 == 0) { oss << "\n"; }
 	}
@@ -16,6 +16,274 @@
 
 #include "DataMemory.hh"
 
+#include <algorithm>
+
+#include "event/MemCompletionEvent.hh"
+
+void DataMemory::init() {
+	this->m_reg         = this->getPipeRegister("bus-m");
+	this->readLatency   = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
+	this->writeLatency  = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_write_latency");
+	this->bytesPerCycle = acalsim::top->getParameter<int>("SOC", "memory_bytes_per_cycle");
+	this->queueDepth    = acalsim::top->getParameter<int>("SOC", "memory_queue_depth");
+	LABELED_ASSERT(this->queueDepth > 0 && this->queueDepth <= kTrackerSlots,
+	               "DataMemory: memory_queue_depth must be within [1, 64]");
+}
+
+void DataMemory::setNumMasters(size_t _num_masters) {
+	this->pendingQ.resize(_num_masters);
+	this->masterQoS.assign(_num_masters, 0);
+	this->heads.resize(_num_masters);
+	this->masterStats.resize(_num_masters);
+}
+
+void DataMemory::cleanup() {
+	CLASS_INFO << "[DataMemory] arbitration policy: " << BusArbiter::policyName(this->arbiter.getPolicy());
+	for (size_t master = 0; master < this->masterStats.size(); master++) {
+		MasterQueueStats& stats = this->masterStats[master];
+		if (stats.requests == 0) continue;
+		CLASS_INFO << "[DataMemory] master " << MasterRegistry::nameOf(master) << ": " << stats.requests
+		           << " bursts, avg queueing delay " << (double)stats.totalDelay / (double)stats.requests
+		           << " ticks, max " << stats.maxDelay << " ticks";
+		const LatencyHistogram& hist = stats.latency;
+		if (hist.count() == 0) continue;
+		CLASS_INFO << "[DataMemory] master " << MasterRegistry::nameOf(master) << " latency: p50 "
+		           << hist.percentile(0.50) << ", p95 " << hist.percentile(0.95) << ", p99 " << hist.percentile(0.99)
+		           << ", max " << hist.max() << " ticks";
+	}
+}
+
+void DataMemory::step() {
+	if (!respQ_.empty()) { this->trySendResponse(); }
+	this->acceptRequests();
+}
+
+void DataMemory::acceptRequests() {
+	for (auto s_port : this->s_ports_) {
+		// Leave the packet in the port when the queue is full so that the CrossBar sees the stall
+		if (this->inFlight + this->numPending >= this->queueDepth) break;
+		if (!s_port.second->isPopValid()) continue;
+		this->acceptRequest(static_cast<XBarPacket*>(s_port.second->pop()));
+	}
+	this->grantChannel();
+}
+
+void DataMemory::acceptRequest(XBarPacket* _packet) {
+	PacketKind kind = _packet->getKind();
+	if (kind != PacketKind::MEM_READ_REQ && kind != PacketKind::MEM_WRITE_REQ) {
+		CLASS_ERROR << "DataMemory received an unexpected packet type";
+		return;
+	}
+	size_t master = _packet->getSrcIdx();
+	LABELED_ASSERT(master < this->pendingQ.size(), "DataMemory: request from a master the memory was not sized for");
+	this->masterQoS[master] = _packet->getQoS();
+	// On a NoC the request occupies a queue entry now but is not eligible for arbitration before its tail arrives
+	acalsim::Tick now     = acalsim::top->getGlobalTick();
+	acalsim::Tick arrival = std::max(now, _packet->getNetArrival());
+	if (arrival > now) { this->pushCompletion(arrival, CompletionKind::GRANT); }
+	this->pendingQ[master].push_back({_packet, arrival});
+	this->numPending++;
+}
+
+void DataMemory::grantChannel() {
+	acalsim::Tick now = acalsim::top->getGlobalTick();
+	while (this->numPending > 0) {
+		// The channel is still busy: come back when it frees up
+		if (this->bytesPerCycle > 0 && this->channelFreeTick > now) {
+			if (this->grantTick != this->channelFreeTick) {
+				this->pushCompletion(this->channelFreeTick, CompletionKind::GRANT);
+				this->grantTick = this->channelFreeTick;
+			}
+			return;
+		}
+
+		bool any = false;
+		for (size_t m = 0; m < this->pendingQ.size(); m++) {
+			bool valid     = !this->pendingQ[m].empty() && this->pendingQ[m].front().arrival <= now;
+			this->heads[m] = {valid, this->masterQoS[m], valid ? this->pendingQ[m].front().pkt->getIssueTick() : 0};
+			any |= valid;
+		}
+		// Every pending request is still crossing the NoC; its arrival GRANT retries
+		if (!any) return;
+		size_t         master = this->arbiter.select(this->heads);
+		PendingRequest req    = this->pendingQ[master].front();
+		this->pendingQ[master].pop_front();
+		this->numPending--;
+		this->startBurst(req.pkt, req.arrival);
+	}
+}
+
+void DataMemory::startBurst(XBarPacket* _packet, acalsim::Tick _arrival) {
+	auto          rc         = acalsim::top->getRecycleContainer();
+	acalsim::Tick now        = acalsim::top->getGlobalTick();
+	PacketKind    kind       = _packet->getKind();
+	int           burst_size = _packet->getBurstSize();
+	// Reads and writes have their own access latency, so a later write may be answered before an earlier read to
+	// another address. Overlapping beats are kept in grant order by `order`.
+	acalsim::Tick delay_lentency = kind == PacketKind::MEM_WRITE_REQ ? this->writeLatency : this->readLatency;
+
+	// Every beat moves one 32-bit word over a channel that serves `bytesPerCycle` bytes per tick
+	acalsim::Tick start = now;
+	if (this->bytesPerCycle > 0) {
+		this->channelFreeTick = start + (burst_size * 4 + this->bytesPerCycle - 1) / this->bytesPerCycle;
+	}
+	acalsim::Tick lastTick = start;
+
+	auto beatTick = [&](int _beat, uint32_t _addr, bool _write) {
+		acalsim::Tick offset = this->bytesPerCycle > 0 ? (acalsim::Tick)(_beat * 4 / this->bytesPerCycle) : _beat;
+		// Beats of one burst stay in order, so the tracker collects them by arrival
+		lastTick = this->order.schedule(now, std::max(lastTick, start + offset + delay_lentency), _addr, 4, _write);
+		return lastTick;
+	};
+
+	size_t            master = _packet->getSrcIdx();
+	MasterQueueStats& stats  = this->masterStats[master];
+	stats.requests++;
+	stats.totalDelay += start - _arrival;
+	stats.maxDelay = std::max(stats.maxDelay, start - _arrival);
+
+	int tid = _packet->getAutoIncTID();
+	// read req handling
+	if (kind == PacketKind::MEM_READ_REQ) {
+		auto ReadReqPkt = static_cast<XBarMemReadReqPacket*>(_packet);
+		auto payload    = ReadReqPkt->getPayloads();
+		if (payload.size() != burst_size) {
+			CLASS_ERROR << "Get size : " << payload.size() << " burst indicates: " << burst_size;
+		}
+		assert(payload.size() == burst_size);
+
+		BurstTracker& tk   = this->acquireTracker(tid, burst_size);
+		int           slot = &tk - this->trackers.data();
+		tk.master          = master;
+		tk.issue           = _packet->getIssueTick();
+		for (int i = 0; i < burst_size; i++) {
+			tk.rreqs[i] = payload[i];
+			bool amo    = payload[i]->getOP() >= AMOSWAP_W && payload[i]->getOP() <= AMOMAXU_W;
+			this->pushCompletion(beatTick(i, payload[i]->getAddr(), amo), CompletionKind::READ_BEAT, slot, i);
+		}
+		rc->recycle(ReadReqPkt);
+	}
+	// Write req handling
+	if (kind == PacketKind::MEM_WRITE_REQ) {
+		auto WriteReq = static_cast<XBarMemWriteReqPacket*>(_packet);
+		auto payload  = WriteReq->getPayloads();
+		assert(payload.size() == burst_size);
+
+		BurstTracker& tk   = this->acquireTracker(tid, burst_size);
+		int           slot = &tk - this->trackers.data();
+		tk.master          = master;
+		tk.issue           = _packet->getIssueTick();
+		for (int i = 0; i < burst_size; i++) {
+			tk.wreqs[i] = payload[i];
+			this->pushCompletion(beatTick(i, payload[i]->getAddr(), true), CompletionKind::WRITE_BEAT, slot, i);
+		}
+		rc->recycle(WriteReq);
+	}
+}
+
+void DataMemory::scheduleRespond() {
+	// Bursts complete in tick order, so only the latest RESPOND can coincide with this one
+	acalsim::Tick when = acalsim::top->getGlobalTick() + 2;
+	if (this->respondTick == when) return;
+	this->pushCompletion(when, CompletionKind::RESPOND);
+	this->respondTick = when;
+}
+
+DataMemory::BurstTracker& DataMemory::trackerOf(int _tid) {
+	int slot = homeSlot(_tid);
+	for (int probe = 0; !this->trackers[slot].busy || this->trackers[slot].tid != _tid; probe++) {
+		LABELED_ASSERT(probe < kTrackerSlots, "DataMemory: no burst in flight for the transaction");
+		slot = (slot + 1) % kTrackerSlots;
+	}
+	return this->trackers[slot];
+}
+
+DataMemory::BurstTracker& DataMemory::acquireTracker(int _tid, int _expected) {
+	// Open addressing from the TID's home slot; queueDepth <= kTrackerSlots guarantees a free slot
+	int slot = homeSlot(_tid);
+	for (int probe = 0; this->trackers[slot].busy; probe++) {
+		LABELED_ASSERT(probe < kTrackerSlots, "DataMemory: too many bursts in flight, no tracker slot is free");
+		slot = (slot + 1) % kTrackerSlots;
+	}
+	BurstTracker& tk = this->trackers[slot];
+	LABELED_ASSERT(_expected > 0 && _expected <= kMaxBurstBeats, "DataMemory: unsupported burst length");
+	tk.busy     = true;
+	tk.tid      = _tid;
+	tk.expected = _expected;
+	tk.received = 0;
+	this->inFlight++;
+	return tk;
+}
+
+void DataMemory::releaseTracker(BurstTracker& _tk) {
+	this->masterStats[_tk.master].latency.record(acalsim::top->getGlobalTick() - _tk.issue);
+	_tk.busy = false;
+	this->inFlight--;
+}
+
+void DataMemory::pushCompletion(acalsim::Tick _when, CompletionKind _kind, int _slot, int _beat) {
+	LABELED_ASSERT(this->numCompletions < kCompletionCap, "DataMemory: completion queue overflow");
+	this->completions[this->numCompletions++] =
+	    Completion{_when, this->completionSeq++, _kind, static_cast<int16_t>(_slot), static_cast<int16_t>(_beat)};
+	std::push_heap(this->completions.begin(), this->completions.begin() + this->numCompletions);
+
+	// Only wake up earlier than the event that is already pending
+	if (_when < this->armedTick) {
+		auto rc    = acalsim::top->getRecycleContainer();
+		auto event = rc->acquire<MemCompletionEvent>(&MemCompletionEvent::renew, this);
+		this->scheduleEvent(event, _when);
+		this->armedTick = _when;
+	}
+}
+
+void DataMemory::serviceCompletions() {
+	acalsim::Tick now = acalsim::top->getGlobalTick();
+	if (this->armedTick <= now) { this->armedTick = kNotArmed; }
+
+	while (this->numCompletions > 0 && this->completions[0].when <= now) {
+		std::pop_heap(this->completions.begin(), this->completions.begin() + this->numCompletions);
+		Completion c = this->completions[--this->numCompletions];
+		switch (c.kind) {
+			case CompletionKind::READ_BEAT:
+				this->memReadReqHandler(c.when, this->trackers[c.slot].rreqs[c.beat]);
+				break;
+			case CompletionKind::WRITE_BEAT:
+				this->memWriteReqHandler(c.when, this->trackers[c.slot].wreqs[c.beat]);
+				break;
+			case CompletionKind::RESPOND: this->trySendResponse(); break;
+			// The channel is free again; acceptRequests() below runs the arbiter
+			case CompletionKind::GRANT: this->grantTick = kNotArmed; break;
+		}
+	}
+
+	// Completed bursts may have freed queue entries for requests held in the slave port
+	this->acceptRequests();
+
+	// A stale event may still fire later; it simply finds nothing due
+	if (this->numCompletions > 0 && this->completions[0].when < this->armedTick) {
+		auto rc    = acalsim::top->getRecycleContainer();
+		auto event = rc->acquire<MemCompletionEvent>(&MemCompletionEvent::renew, this);
+		this->scheduleEvent(event, this->completions[0].when);
+		this->armedTick = this->completions[0].when;
+	}
+}
+
+static uint32_t amoResult(instr_type _op, uint32_t _mem, uint32_t _src) {
+	int32_t mem = static_cast<int32_t>(_mem), src = static_cast<int32_t>(_src);
+	switch (_op) {
+		case AMOSWAP_W: return _src;
+		case AMOADD_W: return _mem + _src;
+		case AMOAND_W: return _mem & _src;
+		case AMOOR_W: return _mem | _src;
+		case AMOXOR_W: return _mem ^ _src;
+		case AMOMIN_W: return static_cast<uint32_t>(std::min(mem, src));
+		case AMOMAX_W: return static_cast<uint32_t>(std::max(mem, src));
+		case AMOMINU_W: return std::min(_mem, _src);
+		case AMOMAXU_W: return std::max(_mem, _src);
+		default: return _mem;
+	}
+}
+
 void DataMemory::memReadReqHandler(acalsim::Tick _when, XBarMemReadReqPayload* _memReqPkt) {
 	// LABELED_INFO(this->getName()) << "DataMemory doing mem read for tid " << _memReqPkt->getTid();
 	instr      i    = _memReqPkt->getInstr();
@@ -23,25 +291,28 @@ void DataMemory::memReadReqHandler(acalsim::Tick _when, XBarMemReadReqPayload* _
 	uint32_t   addr = _memReqPkt->getAddr();
 	operand    a1   = _memReqPkt->getA1();
 
-	size_t   bytes = 0;
-	uint32_t ret   = 0;
-
-	switch (op) {
-		case LB:
-		case LBU: bytes = 1; break;
-		case LH:
-		case LHU: bytes = 2; break;
-		case LW: bytes = 4; break;
-	}
-
-	void* data = this->readData(addr, bytes, false);
+	uint32_t ret = 0;
 
 	switch (op) {
-		case LB: ret = static_cast<uint32_t>(*(int8_t*)data); break;
-		case LBU: ret = *(uint8_t*)data; break;
-		case LH: ret = static_cast<uint32_t>(*(int16_t*)data); break;
-		case LHU: ret = *(uint16_t*)data; break;
-		case LW: ret = *(uint32_t*)data; break;
+		case LB: ret = static_cast<uint32_t>(this->load<int8_t>(addr)); break;
+		case LBU: ret = this->load<uint8_t>(addr); break;
+		case LH: ret = static_cast<uint32_t>(this->load<int16_t>(addr)); break;
+		case LHU: ret = this->load<uint16_t>(addr); break;
+		case LW: ret = this->load<uint32_t>(addr); break;
+		case AMOSWAP_W:
+		case AMOADD_W:
+		case AMOAND_W:
+		case AMOOR_W:
+		case AMOXOR_W:
+		case AMOMIN_W:
+		case AMOMAX_W:
+		case AMOMINU_W:
+		case AMOMAXU_W:
+			// The read-modify-write happens within one beat, so no other master's access can slip in between.
+			// The CPU sends the rs2 value in the immediate of the destination operand.
+			ret = this->load<uint32_t>(addr);
+			this->store<uint32_t>(addr, amoResult(op, ret, a1.imm));
+			break;
 	}
 
 	auto                    rc = acalsim::top->getRecycleContainer();
@@ -50,17 +321,18 @@ void DataMemory::memReadReqHandler(acalsim::Tick _when, XBarMemReadReqPayload* _
 	memRespPkt->setTid(_memReqPkt->getTid());
 
 	/* collect into BurstTracker ------------------------------------ */
-	auto& tk    = pending_[memRespPkt->getTid()];
-	tk.expected = std::max(tk.expected, 1);  // single‑beat burst default
-	tk.rbeats.push_back(memRespPkt);
+	BurstTracker& tk = this->trackerOf(memRespPkt->getTid());
+
+	tk.rbeats[tk.received++] = memRespPkt;
 
-	if ((int)tk.rbeats.size() == tk.expected) {
+	if (tk.received == tk.expected) {
 		/*  assemble one XBarMemReadRespPacket ---------------------- */
-		std::vector<XBarMemReadRespPayload*> beats = std::move(tk.rbeats);
-		pending_.erase(memRespPkt->getTid());
-		auto respPtr = Construct_MemReadRespPkt(beats, "dm" /*src*/, _memReqPkt->getCaller() /*dst*/);
+		std::span<XBarMemReadRespPayload* const> beats(tk.rbeats.data(), tk.expected);
+		this->releaseTracker(tk);
+		auto respPtr = Construct_MemReadRespPkt(beats, _memReqPkt->getMaster() /*dst*/);
 		respPtr->setTID(_memReqPkt->getTid());
 		respQ_.push(respPtr);
+		this->scheduleRespond();
 	}
 	rc->recycle(_memReqPkt);
 }
@@ -72,46 +344,27 @@ void DataMemory::memWriteReqHandler(acalsim::Tick _when, XBarMemWriteReqPayload*
 	uint32_t   addr = _memReqPkt->getAddr();
 	uint32_t   data = _memReqPkt->getData();
 
-	size_t bytes = 0;
-
-	switch (op) {
-		case SB: bytes = 1; break;
-		case SH: bytes = 2; break;
-		case SW: bytes = 4; break;
-	}
-
 	switch (op) {
-		case SB: {
-			uint8_t val8 = static_cast<uint8_t>(data);
-			this->writeData(&val8, addr, 1);
-			break;
-		}
-		case SH: {
-			uint16_t val16 = static_cast<uint16_t>(data);
-			this->writeData(&val16, addr, 2);
-			break;
-		}
-		case SW: {
-			uint32_t val32 = static_cast<uint32_t>(data);
-			this->writeData(&val32, addr, 4);
-			break;
-		}
+		case SB: this->store<uint8_t>(addr, data); break;
+		case SH: this->store<uint16_t>(addr, data); break;
+		case SW: this->store<uint32_t>(addr, data); break;
 	}
 
 	auto                     rc         = acalsim::top->getRecycleContainer();
 	XBarMemWriteRespPayload* memRespPkt = rc->acquire<XBarMemWriteRespPayload>(&XBarMemWriteRespPayload::renew, i);
 	memRespPkt->setTid(_memReqPkt->getTid());
 
-	auto& tk    = pending_[_memReqPkt->getTid()];
-	tk.expected = std::max(tk.expected, 1);
-	tk.wbeats.push_back(memRespPkt);
+	BurstTracker& tk = this->trackerOf(_memReqPkt->getTid());
+
+	tk.wbeats[tk.received++] = memRespPkt;
 
-	if ((int)tk.wbeats.size() == tk.expected) {
-		std::vector<XBarMemWriteRespPayload*> beats = std::move(tk.wbeats);
-		pending_.erase(memRespPkt->getTid());
-		auto respPtr = Construct_MemWriteRespPkt(beats, "dm" /*src*/, _memReqPkt->getCaller() /*dst*/);
+	if (tk.received == tk.expected) {
+		std::span<XBarMemWriteRespPayload* const> beats(tk.wbeats.data(), tk.expected);
+		this->releaseTracker(tk);
+		auto respPtr = Construct_MemWriteRespPkt(beats, _memReqPkt->getMaster() /*dst*/);
 		respPtr->setTID(_memReqPkt->getTid());
 		respQ_.push(respPtr);
+		this->scheduleRespond();
 	}
 	rc->recycle(_memReqPkt);
 }
@@ -119,13 +372,10 @@ void DataMemory::memWriteReqHandler(acalsim::Tick _when, XBarMemWriteReqPayload*
 /* ------------------------------------------------------------------ */
 /*  push if pipe‑reg accepts, else keep in queue                      */
 void DataMemory::trySendResponse() {
-	if (!respQ_.empty()) {
-		if (!m_reg->isStalled()) {
-			if (m_reg->push(respQ_.front())) {
-				// CLASS_INFO << "[DATAMEM] : send packet back";
-				respQ_.pop();
-			}
-		}
+	// One RESPOND may cover several bursts; a refused push leaves the rest to masterPortRetry()
+	while (!respQ_.empty() && this->pushResponse(m_reg, static_cast<XBarPacket*>(respQ_.front()))) {
+		// CLASS_INFO << "[DATAMEM] : send packet back";
+		respQ_.pop();
 	}
 }
 
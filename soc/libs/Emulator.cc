@@ -16,42 +16,47 @@
 
 #include "Emulator.hh"
 
+#include <elf.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <vector>
+
 #include "SystemConfig.hh"
 
-Emulator::Emulator(std::string _name) : label_count(0), memoff(0) {
+#ifndef EM_RISCV
+#define EM_RISCV 243
+#endif
+#ifndef EF_RISCV_RVC
+#define EF_RISCV_RVC 0x1  // e_flags bit of objects that use compressed instructions
+#endif
+
+Emulator::Emulator(std::string _name) : memoff(0) {
+	this->dataBase = acalsim::top->getParameter<int>("Emulator", "data_offset");
+	this->dataEnd  = this->dataBase;
+	this->textSpan = {std::numeric_limits<int>::max(), 0};
+	this->dataSpan = this->textSpan;
+
 	CLASS_INFO << "asm_file_path : " << acalsim::top->getParameter<std::string>("Emulator", "asm_file_path");
 
 	CLASS_INFO << "memory_size : " << acalsim::top->getParameter<int>("Emulator", "memory_size") << " Bytes";
-
-	auto max_label_count = acalsim::top->getParameter<int>("Emulator", "max_label_count");
-	auto max_src_len     = acalsim::top->getParameter<int>("Emulator", "max_src_len");
-	this->labels         = (label_loc*)malloc(max_label_count * sizeof(label_loc));
-	this->src.offset     = 0;
-	this->src.src        = (char*)malloc(sizeof(char) * max_src_len);
 }
 
 void Emulator::init() {}
 
-void Emulator::append_source(const char* _op, const char* _a1, const char* _a2, const char* _a3, source* _src,
-                             instr* _i) {
-	char tbuf[128];  // not safe... static size... but should be okay since label length enforced
-	if (_op && _a1 && !_a2 && !_a3) {
-		sprintf(tbuf, "%s %s", _op, _a1);
-	} else if (_op && _a1 && _a2 && !_a3) {
-		sprintf(tbuf, "%s %s, %s", _op, _a1, _a2);
-	} else if (_op && _a1 && _a2 && _a3) {
-		sprintf(tbuf, "%s %s, %s, %s", _op, _a1, _a2, _a3);
-	} else {
-		return;
-	}
-	int  slen        = strlen(tbuf);
-	auto max_src_len = acalsim::top->getParameter<int>("Emulator", "max_src_len");
-	if (slen + _src->offset < max_src_len) {
-		strncpy(_src->src + _src->offset, tbuf, strlen(tbuf));
-
-		_i->psrc = _src->src + _src->offset;
-		_src->offset += slen + 1;
+char* LineTokenizer::next(const char* _delims) {
+	char* begin = this->rest + strspn(this->rest, _delims);
+	if (*begin == 0) {
+		this->rest = begin;
+		return NULL;
 	}
+	char* end  = begin + strcspn(begin, _delims);
+	this->rest = *end ? end + 1 : end;
+	*end       = 0;
+	return begin;
 }
 
 int Emulator::parse_reg(char* _tok, int _line, bool _strict) {
@@ -100,6 +105,16 @@ int Emulator::parse_reg(char* _tok, int _line, bool _strict) {
 	return -1;
 }
 
+int Emulator::parse_vreg(char* _tok, int _line) {
+	char* end = nullptr;
+	long  vi  = _tok[0] == 'v' ? strtol(_tok + 1, &end, 10) : -1;
+	if (vi < 0 || vi >= NUM_VREGS || end == _tok + 1 || *end != 0) {
+		print_syntax_error(_line, "Malformed vector register name");
+		return -1;
+	}
+	return static_cast<int>(vi);
+}
+
 uint32_t Emulator::parse_imm(char* _tok, int _bits, int _line, bool _strict) {
 	if (!(_tok[0] >= '0' && _tok[0] <= '9') && _tok[0] != '-' && _strict) {
 		print_syntax_error(_line, "Malformed immediate value");
@@ -117,31 +132,31 @@ uint32_t Emulator::parse_imm(char* _tok, int _bits, int _line, bool _strict) {
 }
 
 void Emulator::parse_mem(char* _tok, int* _reg, uint32_t* _imm, int _bits, int _line) {
-	char* imms = strtok(_tok, "(");
-	char* regs = strtok(NULL, ")");
+	LineTokenizer tok(_tok);
+	char*         imms = tok.next("(");
+	char*         regs = tok.next(")");
 	*_imm      = parse_imm(imms, _bits, _line);
 	*_reg      = parse_reg(regs, _line);
 }
 
-int Emulator::parse_assembler_directive(int _line, char* _ftok, uint8_t* _mem, int _memoff) {
+int Emulator::parse_assembler_directive(int _line, LineTokenizer& _tok, char* _ftok, uint8_t* _mem, int _memoff) {
 	// printf( "assembler directive %s\n", ftok );
 	if (0 == memcmp(_ftok, ".text", strlen(_ftok))) {
-		if (strtok(NULL, " \t\r\n")) { print_syntax_error(_line, "Tokens after assembler directive"); }
+		if (_tok.next(" \t\r\n")) { print_syntax_error(_line, "Tokens after assembler directive"); }
 		// cur_section = SECTION_TEXT;
 		auto text_offset = acalsim::top->getParameter<int>("Emulator", "text_offset");
 		_memoff          = text_offset;
 		// printf( "starting text section\n" );
 	} else if (0 == memcmp(_ftok, ".data", strlen(_ftok))) {
 		// cur_section = SECTION_TEXT;
-		auto data_offset = acalsim::top->getParameter<int>("Emulator", "data_offset");
-		_memoff          = data_offset;
+		_memoff = this->dataBase;
 		// printf( "starting data section\n" );
 	} else if (0 == memcmp(_ftok, ".byte", strlen(_ftok)))
-		_memoff = parse_data_element(_line, 1, _mem, _memoff);
+		_memoff = parse_data_element(_line, _tok, 1, _mem, _memoff);
 	else if (0 == memcmp(_ftok, ".half", strlen(_ftok)))
-		_memoff = parse_data_element(_line, 2, _mem, _memoff);
+		_memoff = parse_data_element(_line, _tok, 2, _mem, _memoff);
 	else if (0 == memcmp(_ftok, ".word", strlen(_ftok)))
-		_memoff = parse_data_element(_line, 4, _mem, _memoff);
+		_memoff = parse_data_element(_line, _tok, 4, _mem, _memoff);
 	else {
 		printf("Undefined assembler directive at line %d: %s\n", _line, _ftok);
 		exit(3);
@@ -149,19 +164,20 @@ int Emulator::parse_assembler_directive(int _line, char* _ftok, uint8_t* _mem, i
 	return _memoff;
 }
 
-int Emulator::parse_instr(int _line, char* _ftok, instr* _imem, int _memoff, label_loc* _labels, source* _src) {
+int Emulator::parse_instr(int _line, LineTokenizer& _tok, char* _ftok, instr* _imem, int _memoff,
+                          SymbolTable& _symbols, source _src) {
 	auto data_offset = acalsim::top->getParameter<int>("Emulator", "data_offset");
 	if (_memoff + 4 > data_offset) {
 		printf("Instructions in data segment!\n");
 		exit(1);
 	}
-	char* o1 = strtok(NULL, " \t\r\n,");
-	char* o2 = strtok(NULL, " \t\r\n,");
-	char* o3 = strtok(NULL, " \t\r\n,");
-	char* o4 = strtok(NULL, " \t\r\n,");
+	char* o1 = _tok.next(" \t\r\n,");
+	char* o2 = _tok.next(" \t\r\n,");
+	char* o3 = _tok.next(" \t\r\n,");
+	char* o4 = _tok.next(" \t\r\n,");
 
 	int ioff  = _memoff / 4;
-	int pscnt = parse_pseudoinstructions(_line, _ftok, _imem, ioff, _labels, o1, o2, o3, o4, _src);
+	int pscnt = parse_pseudoinstructions(_line, _ftok, _imem, ioff, _symbols, o1, o2, o3, o4, _src);
 	if (pscnt > 0) {
 		return pscnt;
 	} else {
@@ -169,7 +185,7 @@ int Emulator::parse_instr(int _line, char* _ftok, instr* _imem, int _memoff, lab
 		instr_type op = parse_instr(_ftok);
 		i->op         = op;
 		i->orig_line  = _line;
-		append_source(_ftok, o1, o2, o3, _src, i);
+		i->src        = _src;
 		switch (op) {
 			case UNIMPL: return 1;
 
@@ -179,14 +195,14 @@ int Emulator::parse_instr(int _line, char* _ftok, instr* _imem, int _memoff, lab
 					i->a1.type = OPTYPE_REG;
 					i->a1.reg  = parse_reg(o1, _line);
 					i->a2.type = OPTYPE_LABEL;
-					strncpy(i->a2.label, o2, MAX_LABEL_LEN);
+					i->a2.sym  = _symbols.intern(o2);
 				} else {  // one operand, label
 					if (!o1 || o2 || o3 || o4) print_syntax_error(_line, "Invalid format");
 
 					i->a1.type = OPTYPE_REG;
 					i->a1.reg  = 1;
 					i->a2.type = OPTYPE_LABEL;
-					strncpy(i->a2.label, o1, MAX_LABEL_LEN);
+					i->a2.sym  = _symbols.intern(o1);
 				}
 				return 1;
 			case JALR:
@@ -246,7 +262,7 @@ int Emulator::parse_instr(int _line, char* _ftok, instr* _imem, int _memoff, lab
 				i->a1.reg  = parse_reg(o1, _line);
 				i->a2.reg  = parse_reg(o2, _line);
 				i->a3.type = OPTYPE_LABEL;
-				strncpy(i->a3.label, o3, MAX_LABEL_LEN);
+				i->a3.sym  = _symbols.intern(o3);
 				return 1;
 			case LUI:
 			case AUIPC:  // how to deal with LSB correctly? FIXME
@@ -255,7 +271,36 @@ int Emulator::parse_instr(int _line, char* _ftok, instr* _imem, int _memoff, lab
 				i->a2.imm = (parse_imm(o2, 20, _line));
 				return 1;
 			case HCF: return 1;
+			case FENCE: return 1;  // the predecessor / successor sets are ignored, every fence is a full barrier
+			case AMOSWAP_W:
+			case AMOADD_W:
+			case AMOAND_W:
+			case AMOOR_W:
+			case AMOXOR_W:
+			case AMOMIN_W:
+			case AMOMAX_W:
+			case AMOMINU_W:
+			case AMOMAXU_W: {
+				// amo<op>.w rd, rs2, (rs1)
+				if (!o1 || !o2 || !o3 || o4) print_syntax_error(_line, "Invalid AMO format");
+				char* base = strchr(o3, '(');
+				if (!base || (base != o3 && strtol(o3, NULL, 0) != 0)) {
+					print_syntax_error(_line, "AMO address must be (rs1)");
+				}
+				base[strcspn(base, ")")] = 0;
+				i->a1.reg = parse_reg(o1, _line);        // rd
+				i->a2.reg = parse_reg(base + 1, _line);  // rs1
+				i->a3.reg = parse_reg(o2, _line);        // rs2
+				return 1;
+			}
 			case MUL:
+			case MULH:
+			case MULHSU:
+			case MULHU:
+			case DIV:
+			case DIVU:
+			case REM:
+			case REMU:
 				if (!o1 || !o2 || !o3 || o4) print_syntax_error(_line, "Invalid format");
 				i->a1.reg = parse_reg(o1, _line);
 				i->a2.reg = parse_reg(o2, _line);
@@ -274,6 +319,44 @@ int Emulator::parse_instr(int _line, char* _ftok, instr* _imem, int _memoff, lab
 				i->a2.reg = parse_reg(o2, _line);  // rs1
 				i->a3.reg = parse_reg(o3, _line);  // rs2
 				return 1;
+			case V_ADDI8I8S_VV:
+			case V_ADDI16I16S_VV:
+			case V_SUBI8I8S_VV:
+			case V_SUBI16I16S_VV:
+			case V_PMULI8I16S_VV_L:
+			case V_PMULI8I16S_VV_H:
+			case V_AMULI8I8S_VV_NQ:
+			case V_AMULI8I8S_VV_L:
+				if (!o1 || !o2 || !o3 || o4) print_syntax_error(_line, "Invalid vector format");
+				i->a1.reg = parse_vreg(o1, _line);  // vd
+				i->a2.reg = parse_vreg(o2, _line);  // vs1
+				i->a3.reg = parse_vreg(o3, _line);  // vs2
+				return 1;
+			case VL128:
+			case VS128:
+				// vl128 vd, imm(rs1) / vs128 vs, imm(rs1)
+				if (!o1 || !o2 || o3 || o4) print_syntax_error(_line, "Invalid format");
+				i->a1.reg = parse_vreg(o1, _line);
+				parse_mem(o2, &i->a2.reg, &i->a3.imm, 12, _line);
+				return 1;
+			case VMV_V_X:
+				if (!o1 || !o2 || o3 || o4) print_syntax_error(_line, "Invalid format");
+				i->a1.reg = parse_vreg(o1, _line);  // vd
+				i->a2.reg = parse_reg(o2, _line);   // rs1
+				return 1;
+			case MAC4:
+				// mac4 rs1, rs2; the CFU accumulates the result, so rd is x0
+				if (!o1 || !o2 || o3 || o4) print_syntax_error(_line, "Invalid MAC format");
+				i->a1.reg = 0;
+				i->a2.reg = parse_reg(o1, _line);  // rs1
+				i->a3.reg = parse_reg(o2, _line);  // rs2
+				return 1;
+			case RDACC:
+				if (!o1 || o2 || o3 || o4) print_syntax_error(_line, "Invalid MAC format");
+				i->a1.reg = parse_reg(o1, _line);  // rd
+				i->a2.reg = 0;
+				i->a3.reg = 0;
+				return 1;
 		}
 	}
 	return 1;
@@ -328,8 +411,17 @@ instr_type Emulator::parse_instr(char* _tok) {
 	if (streq(_tok, "auipc")) return AUIPC;
 	if (streq(_tok, "lui")) return LUI;
 
-	// simd instructions
+	// m extension
 	if (streq(_tok, "mul")) return MUL;
+	if (streq(_tok, "mulh")) return MULH;
+	if (streq(_tok, "mulhsu")) return MULHSU;
+	if (streq(_tok, "mulhu")) return MULHU;
+	if (streq(_tok, "div")) return DIV;
+	if (streq(_tok, "divu")) return DIVU;
+	if (streq(_tok, "rem")) return REM;
+	if (streq(_tok, "remu")) return REMU;
+
+	// simd instructions
 	if (streq(_tok, "saddi8i8s.vv")) return S_ADDI8I8S_VV;
 	if (streq(_tok, "saddi16i16s.vv")) return S_ADDI16I16S_VV;
 	if (streq(_tok, "ssubi8i8s.vv")) return S_SUBI8I8S_VV;
@@ -338,14 +430,47 @@ instr_type Emulator::parse_instr(char* _tok) {
 	if (streq(_tok, "spmuli8i16s.vv.h")) return S_PMULI8I16S_VV_H;
 	if (streq(_tok, "samuli8i8s.vv.nq")) return S_AMULI8I8S_VV_NQ;
 	if (streq(_tok, "samuli8i8s.vv.l")) return S_AMULI8I8S_VV_L;
+
+	// vector extension
+	if (streq(_tok, "vl128")) return VL128;
+	if (streq(_tok, "vs128")) return VS128;
+	if (streq(_tok, "vmv.v.x")) return VMV_V_X;
+	if (streq(_tok, "vsaddi8i8s.vv")) return V_ADDI8I8S_VV;
+	if (streq(_tok, "vsaddi16i16s.vv")) return V_ADDI16I16S_VV;
+	if (streq(_tok, "vssubi8i8s.vv")) return V_SUBI8I8S_VV;
+	if (streq(_tok, "vssubi16i16s.vv")) return V_SUBI16I16S_VV;
+	if (streq(_tok, "vspmuli8i16s.vv.l")) return V_PMULI8I16S_VV_L;
+	if (streq(_tok, "vspmuli8i16s.vv.h")) return V_PMULI8I16S_VV_H;
+	if (streq(_tok, "vsamuli8i8s.vv.nq")) return V_AMULI8I8S_VV_NQ;
+	if (streq(_tok, "vsamuli8i8s.vv.l")) return V_AMULI8I8S_VV_L;
+
+	// MAC extension
+	if (streq(_tok, "mac4")) return MAC4;
+	if (streq(_tok, "rdacc")) return RDACC;
 	// unimpl
 	// if ( streq(tok, "unimpl") ) return UNIMPL;
 	if (streq(_tok, "hcf")) return HCF;
+
+	// atomics; AMOs are performed in order, so the .aq / .rl / .aqrl suffixes need no extra handling
+	if (streq(_tok, "fence")) return FENCE;
+	char amo[16];
+	strncpy(amo, _tok, sizeof(amo) - 1);
+	amo[sizeof(amo) - 1] = 0;
+	if (char* order = strstr(amo, ".w.")) order[2] = 0;
+	if (streq(amo, "amoswap.w")) return AMOSWAP_W;
+	if (streq(amo, "amoadd.w")) return AMOADD_W;
+	if (streq(amo, "amoand.w")) return AMOAND_W;
+	if (streq(amo, "amoor.w")) return AMOOR_W;
+	if (streq(amo, "amoxor.w")) return AMOXOR_W;
+	if (streq(amo, "amomin.w")) return AMOMIN_W;
+	if (streq(amo, "amomax.w")) return AMOMAX_W;
+	if (streq(amo, "amominu.w")) return AMOMINU_W;
+	if (streq(amo, "amomaxu.w")) return AMOMAXU_W;
 	return UNIMPL;
 }
 
-int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int _ioff, label_loc* _labels, char* _o1,
-                                       char* _o2, char* _o3, char* _o4, source* _src) {
+int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int _ioff, SymbolTable& _symbols,
+                                       char* _o1, char* _o2, char* _o3, char* _o4, source _src) {
 	if (streq(_ftok, "li")) {
 		if (!_o1 || !_o2 || _o3) print_syntax_error(_line, "Invalid format");
 
@@ -359,13 +484,6 @@ int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int
 		uint64_t uv = *(uint64_t*)&imml;
 		uint32_t hv = (uv & UINT32_MAX);
 
-		char areg[4];
-		sprintf(areg, "x%02d", reg);
-		char immu[12];
-		sprintf(immu, "0x%08x", (hv >> 12));
-		char immd[12];
-		sprintf(immd, "0x%08x", (hv & ((1 << 12) - 1)));
-
 		instr* i     = &_imem[_ioff];
 		i->op        = LUI;
 		i->a1.type   = OPTYPE_REG;
@@ -373,8 +491,8 @@ int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int
 		i->a2.type   = OPTYPE_IMM;
 		i->a2.imm    = hv >> 12;
 		i->orig_line = _line;
-		append_source("lui", areg, immu, NULL, _src, i);
-		instr* i2 = &_imem[_ioff + 1];
+		i->src       = _src;
+		instr* i2    = &_imem[_ioff + 1];
 
 		i2->op        = ADDI;
 		i2->a1.type   = OPTYPE_REG;
@@ -384,7 +502,7 @@ int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int
 		i2->a3.type   = OPTYPE_IMM;
 		i2->a3.imm    = (hv & ((1 << 12) - 1));
 		i2->orig_line = _line;
-		append_source("addi", areg, areg, immd, _src, i2);
+		i2->src       = _src;
 		return 2;
 	}
 	if (streq(_ftok, "la")) {
@@ -392,24 +510,24 @@ int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int
 
 		int reg = parse_reg(_o1, _line);
 
-		instr* i   = &_imem[_ioff];
-		i->op      = LUI;
-		i->a1.type = OPTYPE_REG;
-		i->a1.reg  = reg;
-		i->a2.type = OPTYPE_LABEL;
-		strncpy(i->a2.label, _o2, MAX_LABEL_LEN);
+		instr* i     = &_imem[_ioff];
+		i->op        = LUI;
+		i->a1.type   = OPTYPE_REG;
+		i->a1.reg    = reg;
+		i->a2.type   = OPTYPE_LABEL;
+		i->a2.sym    = _symbols.intern(_o2);
 		i->orig_line = _line;
-		// append_source(ftok, o1, o2, o3, src, i); // done in normalize
-		instr* i2   = &_imem[_ioff + 1];
-		i2->op      = ADDI;
-		i2->a1.type = OPTYPE_REG;
-		i2->a1.reg  = reg;
-		i2->a2.type = OPTYPE_REG;
-		i2->a2.reg  = reg;
-		i2->a3.type = OPTYPE_LABEL;
-		strncpy(i2->a3.label, _o2, MAX_LABEL_LEN);
+		i->src       = _src;
+		instr* i2     = &_imem[_ioff + 1];
+		i2->op        = ADDI;
+		i2->a1.type   = OPTYPE_REG;
+		i2->a1.reg    = reg;
+		i2->a2.type   = OPTYPE_REG;
+		i2->a2.reg    = reg;
+		i2->a3.type   = OPTYPE_LABEL;
+		i2->a3.sym    = _symbols.intern(_o2);
 		i2->orig_line = _line;
-		// append_source(ftok, o1, o2, o3, src, i2); // done in normalize
+		i2->src       = _src;
 		return 2;
 	}
 	if (streq(_ftok, "ret")) {
@@ -424,20 +542,20 @@ int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int
 		i->a3.type   = OPTYPE_IMM;
 		i->a3.imm    = 0;
 		i->orig_line = _line;
-		append_source("jalr", "x0", "x1", "x0", _src, i);
+		i->src       = _src;
 		return 1;
 	}
 	if (streq(_ftok, "j")) {
 		if (!_o1 || _o2) print_syntax_error(_line, "Invalid format");
 
-		instr* i   = &_imem[_ioff];
-		i->op      = JAL;
-		i->a1.type = OPTYPE_REG;
-		i->a1.reg  = 0;
-		i->a2.type = OPTYPE_LABEL;
-		strncpy(i->a2.label, _o1, MAX_LABEL_LEN);
+		instr* i     = &_imem[_ioff];
+		i->op        = JAL;
+		i->a1.type   = OPTYPE_REG;
+		i->a1.reg    = 0;
+		i->a2.type   = OPTYPE_LABEL;
+		i->a2.sym    = _symbols.intern(_o1);
 		i->orig_line = _line;
-		append_source("j", "x0", _o1, NULL, _src, i);
+		i->src       = _src;
 		return 1;
 	}
 	if (streq(_ftok, "mv")) {
@@ -451,42 +569,43 @@ int Emulator::parse_pseudoinstructions(int _line, char* _ftok, instr* _imem, int
 		i->a3.type   = OPTYPE_IMM;
 		i->a3.imm    = 0;
 		i->orig_line = _line;
-		append_source("addi", _o1, _o2, NULL, _src, i);
+		i->src       = _src;
 		return 1;
 	}
 	if (streq(_ftok, "bnez")) {
 		if (!_o1 || !_o2 || _o3) print_syntax_error(_line, "Invalid format");
-		instr* i   = &_imem[_ioff];
-		i->op      = BNE;
-		i->a1.type = OPTYPE_REG;
-		i->a1.reg  = parse_reg(_o1, _line);
-		i->a2.type = OPTYPE_REG;
-		i->a2.reg  = 0;
-		i->a3.type = OPTYPE_LABEL;
-		strncpy(i->a3.label, _o2, MAX_LABEL_LEN);
+		instr* i     = &_imem[_ioff];
+		i->op        = BNE;
+		i->a1.type   = OPTYPE_REG;
+		i->a1.reg    = parse_reg(_o1, _line);
+		i->a2.type   = OPTYPE_REG;
+		i->a2.reg    = 0;
+		i->a3.type   = OPTYPE_LABEL;
+		i->a3.sym    = _symbols.intern(_o2);
 		i->orig_line = _line;
-		append_source("bne", "x0", _o1, _o2, _src, i);
+		i->src       = _src;
 		return 1;
 	}
 	if (streq(_ftok, "beqz")) {
 		if (!_o1 || !_o2 || _o3) print_syntax_error(_line, "Invalid format");
-		instr* i   = &_imem[_ioff];
-		i->op      = BEQ;
-		i->a1.type = OPTYPE_REG;
-		i->a1.reg  = parse_reg(_o1, _line);
-		i->a2.type = OPTYPE_REG;
-		i->a2.reg  = 0;
-		i->a3.type = OPTYPE_LABEL;
-		strncpy(i->a3.label, _o2, MAX_LABEL_LEN);
+		instr* i     = &_imem[_ioff];
+		i->op        = BEQ;
+		i->a1.type   = OPTYPE_REG;
+		i->a1.reg    = parse_reg(_o1, _line);
+		i->a2.type   = OPTYPE_REG;
+		i->a2.reg    = 0;
+		i->a3.type   = OPTYPE_LABEL;
+		i->a3.sym    = _symbols.intern(_o2);
 		i->orig_line = _line;
-		append_source("beq", "x0", _o1, _o2, _src, i);
+		i->src       = _src;
 		return 1;
 	}
 	return 0;
 }
 
-int Emulator::parse_data_element(int _line, int _size, uint8_t* _mem, int _offset) {
-	while (char* t = strtok(NULL, " \t\r\n")) {
+int Emulator::parse_data_element(int _line, LineTokenizer& _tok, int _size, uint8_t* _mem, int _offset) {
+	int begin = _offset;
+	while (char* t = _tok.next(" \t\r\n")) {
 		errno      = 0;
 		int64_t v  = strtol(t, NULL, 0);
 		int64_t vs = (v >> (_size * 8));
@@ -497,8 +616,8 @@ int Emulator::parse_data_element(int _line, int _size, uint8_t* _mem, int _offse
 		// printf ( "parse_data_element %d: %d %ld %d %d\n", line, size, v, errno, sizeof(long int));
 		memcpy(&_mem[_offset], &v, _size);
 		_offset += _size;
-		// strtok(NULL, ",");
 	}
+	this->markWritten(begin, _offset);
 	return _offset;
 }
 
@@ -518,70 +637,184 @@ uint32_t Emulator::signextend(uint32_t _in, int _bits) {
 }
 
 void Emulator::parse(const std::string& _file_path, uint8_t* _mem, instr* _imem) {
-	this->parse(_file_path, _mem, _imem, this->memoff, this->labels, this->label_count, &(this->src));
+	this->parse(this->openSource(_file_path).text(), _mem, _imem, this->memoff, this->symbols);
 }
 
-void Emulator::parse(const std::string& _file_path, uint8_t* _mem, instr* _imem, int& _memoff, label_loc* _labels,
-                     int& _label_count, source* _src) {
-	FILE* fin = fopen(_file_path.c_str(), "r");
-	if (!fin) { ERROR << _file_path << ": No such file"; }
+void Emulator::parse(std::string_view _text, uint8_t* _mem, instr* _imem, int& _memoff, SymbolTable& _symbols) {
 	int line = 0;
 
 	CLASS_INFO << "Parsing input file";
 
-	// sectionType cur_section = SECTION_NONE;
-	char rbuf[1024];
-	while (!feof(fin)) {
-		if (!fgets(rbuf, 1024, fin)) break;
-		for (char* p = rbuf; *p; ++p) *p = tolower(*p);
+	// Each line is copied and lowercased before it is tokenized, since the text itself may be a read-only mapping
+	std::string rbuf;
+	for (size_t at = 0; at < _text.size();) {
+		size_t end = std::min(_text.find('\n', at), _text.size());
+		rbuf.assign(_text.data() + at, end - at);
+		for (char& c : rbuf) c = tolower(c);
+		size_t begin = at;
+		size_t stop  = rbuf.find_last_not_of(" \t\r") + 1;  // before the tokenizer writes its terminators
+		at           = end + 1;
 		line++;
 
-		char* _ftok = strtok(rbuf, " \t\r\n");
+		LineTokenizer tok(rbuf.data());
+		char*         _ftok = tok.next(" \t\r\n");
 		if (!_ftok) continue;
 
+		// An instruction's source is the rest of its line, trailing blanks aside
+		auto src_of = [&](const char* _op) {
+			size_t from = _op - rbuf.data();
+			return source{static_cast<uint32_t>(begin + from), static_cast<uint32_t>(stop - from)};
+		};
+
 		if (_ftok[0] == '#') continue;
 		if (_ftok[0] == '.') {
-			_memoff = parse_assembler_directive(line, _ftok, _mem, _memoff);
+			_memoff = parse_assembler_directive(line, tok, _ftok, _mem, _memoff);
 		} else if (_ftok[strlen(_ftok) - 1] == ':') {
 			_ftok[strlen(_ftok) - 1] = 0;
-			if (strlen(_ftok) >= MAX_LABEL_LEN) {
-				printf("Exceeded maximum length of label: %s\n", _ftok);
-				exit(3);
-			}
-			auto max_label_count = acalsim::top->getParameter<int>("Emulator", "max_label_count");
-			if (_label_count >= max_label_count) {
-				printf("Exceeded maximum number of supported labels");
-				exit(3);
-			}
-			strncpy(_labels[_label_count].label, _ftok, MAX_LABEL_LEN);
-			_labels[_label_count].loc = _memoff;
-			_label_count++;
+			_symbols.define(_symbols.intern(_ftok), _memoff);  // a repeated label keeps its first address
 			// printf( "Parsing label %s at mem %x\n", ftok, memoff );
 
-			char* ntok = strtok(NULL, " \t\r\n");
+			char* ntok = tok.next(" \t\r\n");
 			// there is more code after label
 			if (ntok) {
 				if (ntok[0] == '.') {
-					_memoff = parse_assembler_directive(line, ntok, _mem, _memoff);
+					_memoff = parse_assembler_directive(line, tok, ntok, _mem, _memoff);
 				} else {
-					int count = parse_instr(line, ntok, _imem, _memoff, _labels, _src);
+					int count = parse_instr(line, tok, ntok, _imem, _memoff, _symbols, src_of(ntok));
 					for (int i = 0; i < count; i++) *(uint32_t*)&_mem[_memoff + (i * 4)] = 0xcccccccc;
+					this->markWritten(_memoff, _memoff + count * 4);
 					_memoff += count * 4;
 				}
 			}
 		} else {
-			int count = parse_instr(line, _ftok, _imem, _memoff, _labels, _src);
+			int count = parse_instr(line, tok, _ftok, _imem, _memoff, _symbols, src_of(_ftok));
 			for (int i = 0; i < count; i++) *(uint32_t*)&_mem[_memoff + (i * 4)] = 0xcccccccc;
+			this->markWritten(_memoff, _memoff + count * 4);
 			_memoff += count * 4;
 		}
+		// Text lives below data_offset, so the high-water mark is the end of the data section
+		if (_memoff > this->dataEnd) this->dataEnd = _memoff;
+	}
+}
+
+const MappedFile& Emulator::openSource(const std::string& _file_path) {
+	MappedFile& file = this->sources.emplace_back();
+	if (!file.open(_file_path)) { ERROR << _file_path << ": No such file"; }
+	return file;
+}
+
+void Emulator::beginProgram() {
+	// The previous program keeps what it wrote; an ELF program records its segments as it loads them
+	for (const auto& span : {this->textSpan, this->dataSpan}) {
+		if (span.first < span.second) this->claimed.push_back(span);
+	}
+	this->symbols.clear();
+	this->memoff      = 0;
+	this->dataBase    = (this->dataEnd + 3) & ~3;
+	this->textSpan    = {std::numeric_limits<int>::max(), 0};
+	this->dataSpan    = this->textSpan;
+}
+
+void Emulator::markWritten(int _from, int _to) {
+	if (_from >= _to) return;
+	auto& span  = _from < this->dataBase ? this->textSpan : this->dataSpan;
+	span.first  = std::min(span.first, _from);
+	span.second = std::max(span.second, _to);
+}
+
+void Emulator::assemble(const std::string& _file_path, uint8_t* _mem, instr* _imem) {
+	auto             cache_dir = acalsim::top->getParameter<std::string>("Emulator", "image_cache_dir");
+	std::string_view text      = this->openSource(_file_path).text();
+	if (cache_dir.empty()) {
+		this->parse(text, _mem, _imem, this->memoff, this->symbols);
+		this->normalize_labels(_imem);
+		return;
+	}
+
+	uint64_t key = this->imageKey(text);
+	char     name[32];
+	snprintf(name, sizeof(name), "%016llx.img", static_cast<unsigned long long>(key));
+	std::string  image_path = (std::filesystem::path(cache_dir) / name).string();
+	ProgramImage image;
+	if (image.map(image_path, key) && this->restoreImage(image.contents(), _mem, _imem)) {
+		CLASS_INFO << "Loaded cached image " << image_path << " of " << _file_path;
+		return;
+	}
+
+	this->parse(text, _mem, _imem, this->memoff, this->symbols);
+	this->normalize_labels(_imem);
+
+	std::error_code ec;
+	std::filesystem::create_directories(cache_dir, ec);
+	if (this->saveImage(image_path, key, _mem, _imem)) {
+		CLASS_INFO << "Cached the image of " << _file_path << " as " << image_path;
+	} else {
+		CLASS_INFO << "Could not write the image cache " << image_path;
+	}
+}
+
+uint64_t Emulator::imageKey(std::string_view _text) const {
+	// Anything else that changes the assembled bytes or addresses must be part of the key
+	const int64_t layout[] = {ProgramImage::kVersion,
+	                          static_cast<int64_t>(_text.size()),
+	                          sizeof(instr),
+	                          NOP,
+	                          acalsim::top->getParameter<int>("Emulator", "text_offset"),
+	                          acalsim::top->getParameter<int>("Emulator", "data_offset"),
+	                          acalsim::top->getParameter<int>("Emulator", "memory_size"),
+	                          this->dataBase};
+	return ProgramImage::hash(layout, sizeof(layout), ProgramImage::hash(_text.data(), _text.size()));
+}
+
+bool Emulator::restoreImage(const ProgramImage::Contents& _contents, uint8_t* _mem, instr* _imem) {
+	size_t memory_size = acalsim::top->getParameter<int>("Emulator", "memory_size");
+	if (_contents.imem.size() != static_cast<size_t>(acalsim::top->getParameter<int>("Emulator", "data_offset") / 4)) {
+		return false;
+	}
+	for (const ProgramImage::Segment& segment : _contents.segments) {
+		if (segment.addr > memory_size || segment.bytes.size() > memory_size - segment.addr) return false;
+	}
+
+	// The source spans index the program text, which hashed to the same key, so they are copied as they are
+	for (const ProgramImage::Segment& segment : _contents.segments) {
+		memcpy(_mem + segment.addr, segment.bytes.data(), segment.bytes.size());
+		this->markWritten(static_cast<int>(segment.addr), static_cast<int>(segment.addr + segment.bytes.size()));
+	}
+	memcpy(_imem, _contents.imem.data(), _contents.imem.size_bytes());
+
+	this->symbols.reserve(_contents.symbols.size());
+	for (const auto& [name, loc] : _contents.symbols) {
+		SymbolTable::SymbolID id = this->symbols.intern(name);
+		if (loc >= 0) this->symbols.define(id, loc);
+	}
+	this->memoff  = _contents.memoff;
+	this->dataEnd = std::max(this->dataEnd, _contents.dataEnd);
+	return true;
+}
+
+bool Emulator::saveImage(const std::string& _image_path, uint64_t _key, const uint8_t* _mem,
+                         const instr* _imem) const {
+	ProgramImage::Contents contents;
+	contents.imem = {_imem, static_cast<size_t>(acalsim::top->getParameter<int>("Emulator", "data_offset") / 4)};
+	for (const auto& span : {this->textSpan, this->dataSpan}) {
+		if (span.first >= span.second) continue;
+		contents.segments.push_back({static_cast<uint32_t>(span.first),
+		                             {_mem + span.first, static_cast<size_t>(span.second - span.first)}});
 	}
+	for (SymbolTable::SymbolID id = 0; id < this->symbols.size(); id++) {
+		int64_t loc = this->symbols.isDefined(id) ? this->symbols.location(id) : -1;
+		contents.symbols.emplace_back(this->symbols.name(id), loc);
+	}
+	contents.memoff  = this->memoff;
+	contents.dataEnd = this->dataEnd;
+	return ProgramImage::write(_image_path, _key, contents);
 }
 
 void Emulator::normalize_labels(instr* _imem) {
-	this->normalize_labels(_imem, this->labels, this->label_count, &(this->src));
+	this->normalize_labels(_imem, this->symbols);
 }
 
-void Emulator::normalize_labels(instr* _imem, label_loc* _labels, int _label_count, source* _src) {
+void Emulator::normalize_labels(instr* _imem, const SymbolTable& _symbols) {
 	auto data_offset = acalsim::top->getParameter<int>("Emulator", "data_offset");
 	for (int i = 0; i < data_offset / 4; i++) {
 		instr* ii = &_imem[i];
@@ -589,22 +822,13 @@ void Emulator::normalize_labels(instr* _imem, label_loc* _labels, int _label_cou
 
 		if (ii->a1.type == OPTYPE_LABEL) {
 			ii->a1.type = OPTYPE_IMM;
-			ii->a1.imm  = label_addr(ii->a1.label, _labels, _label_count, ii->orig_line);
+			ii->a1.imm  = label_addr(ii->a1.sym, _symbols, ii->orig_line);
 		}
 		if (ii->a2.type == OPTYPE_LABEL) {
 			ii->a2.type = OPTYPE_IMM;
-			ii->a2.imm  = label_addr(ii->a2.label, _labels, _label_count, ii->orig_line);
+			ii->a2.imm  = label_addr(ii->a2.sym, _symbols, ii->orig_line);
 			switch (ii->op) {
-				case LUI: {
-					ii->a2.imm = (ii->a2.imm >> 12);
-					char areg[4];
-					sprintf(areg, "x%02d", ii->a1.reg);
-					char immu[12];
-					sprintf(immu, "0x%08x", ii->a2.imm);
-					// printf( "LUI %d 0x%x %s\n", ii->a1.reg, ii->a2.imm, immu );
-					append_source("lui", areg, immu, NULL, _src, ii);
-					break;
-				}
+				case LUI: ii->a2.imm = (ii->a2.imm >> 12); break;
 				case JAL:
 					int pc     = (i * 4);
 					int target = ii->a3.imm;
@@ -620,20 +844,9 @@ void Emulator::normalize_labels(instr* _imem, label_loc* _labels, int _label_cou
 		}
 		if (ii->a3.type == OPTYPE_LABEL) {
 			ii->a3.type = OPTYPE_IMM;
-			ii->a3.imm  = label_addr(ii->a3.label, _labels, _label_count, ii->orig_line);
+			ii->a3.imm  = label_addr(ii->a3.sym, _symbols, ii->orig_line);
 			switch (ii->op) {
-				case ADDI: {
-					ii->a3.imm = ii->a3.imm & ((1 << 12) - 1);
-					char a1reg[4];
-					sprintf(a1reg, "x%02d", ii->a1.reg);
-					char a2reg[4];
-					sprintf(a2reg, "x%02d", ii->a2.reg);
-					char immd[12];
-					sprintf(immd, "0x%08x", ii->a3.imm);
-					// printf( "ADDI %d %d 0x%x %s\n", ii->a1.reg, ii->a2.reg, ii->a3.imm, immd );
-					append_source("addi", a1reg, a2reg, immd, _src, ii);
-					break;
-				}
+				case ADDI: ii->a3.imm = ii->a3.imm & ((1 << 12) - 1); break;
 				case BEQ:
 				case BGE:
 				case BGEU:
@@ -656,10 +869,226 @@ void Emulator::normalize_labels(instr* _imem, label_loc* _labels, int _label_cou
 	}
 }
 
-uint32_t Emulator::label_addr(char* _label, label_loc* _labels, int _label_count, int _orig_line) {
-	for (int i = 0; i < _label_count; i++) {
-		if (streq(_labels[i].label, _label)) return _labels[i].loc;
-	}
-	print_syntax_error(_orig_line, "Undefined label");
+uint32_t Emulator::label_addr(SymbolTable::SymbolID _sym, const SymbolTable& _symbols, int _orig_line) {
+	if (_symbols.isDefined(_sym)) return _symbols.location(_sym);
+	print_syntax_error(_orig_line, ("Undefined label " + std::string(_symbols.name(_sym))).c_str());
 	return -1;
 }
+
+bool Emulator::isElf(const std::string& _file_path) {
+	FILE* fin = fopen(_file_path.c_str(), "rb");
+	if (!fin) return false;
+	unsigned char magic[SELFMAG];
+	bool          elf = fread(magic, 1, SELFMAG, fin) == SELFMAG && memcmp(magic, ELFMAG, SELFMAG) == 0;
+	fclose(fin);
+	return elf;
+}
+
+uint32_t Emulator::loadElf(const std::string& _file_path, uint8_t* _mem, instr* _imem) {
+	std::ifstream fin(_file_path, std::ios::binary);
+	if (!fin) { ERROR << _file_path << ": No such file"; }
+	std::vector<char> image((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+	CLASS_INFO << "Loading ELF file " << _file_path;
+
+	Elf32_Ehdr ehdr;
+	if (image.size() < sizeof(ehdr)) { ERROR << _file_path << ": Truncated ELF header"; }
+	memcpy(&ehdr, image.data(), sizeof(ehdr));
+	if (memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 || ehdr.e_ident[EI_CLASS] != ELFCLASS32 ||
+	    ehdr.e_ident[EI_DATA] != ELFDATA2LSB || ehdr.e_machine != EM_RISCV) {
+		ERROR << _file_path << ": Not a little-endian RV32 ELF file";
+	}
+	if (ehdr.e_type != ET_EXEC) { ERROR << _file_path << ": Only statically linked executables can be loaded"; }
+	if (ehdr.e_flags & EF_RISCV_RVC) { ERROR << _file_path << ": Compressed instructions are not supported"; }
+
+	uint32_t text_offset = acalsim::top->getParameter<int>("Emulator", "text_offset");
+	uint32_t data_offset = acalsim::top->getParameter<int>("Emulator", "data_offset");
+	uint32_t memory_size = acalsim::top->getParameter<int>("Emulator", "memory_size");
+	size_t   decoded = 0, unknown = 0;
+	for (size_t n = 0; n < ehdr.e_phnum; n++) {
+		Elf32_Phdr phdr;
+		size_t     at = ehdr.e_phoff + n * ehdr.e_phentsize;
+		if (at + sizeof(phdr) > image.size()) { ERROR << _file_path << ": Truncated program header table"; }
+		memcpy(&phdr, image.data() + at, sizeof(phdr));
+		if (phdr.p_type != PT_LOAD || phdr.p_memsz == 0) continue;
+
+		uint64_t end = uint64_t{phdr.p_vaddr} + phdr.p_memsz;
+		if (end > memory_size || phdr.p_filesz > phdr.p_memsz || phdr.p_offset + phdr.p_filesz > image.size()) {
+			ERROR << _file_path << ": Segment at 0x" << std::hex << phdr.p_vaddr << " does not fit the "
+			      << std::dec << memory_size << "-byte memory";
+		}
+		int begin = static_cast<int>(phdr.p_vaddr);
+		for (const auto& [from, to] : this->claimed) {
+			if (begin >= to || static_cast<int>(end) <= from) continue;
+			ERROR << _file_path << ": Segment [0x" << std::hex << begin << ", 0x" << end << ") overlaps [0x" << from
+			      << ", 0x" << to << "), which is already loaded";
+		}
+		this->claimed.emplace_back(begin, static_cast<int>(end));
+		memcpy(_mem + phdr.p_vaddr, image.data() + phdr.p_offset, phdr.p_filesz);
+		memset(_mem + phdr.p_vaddr + phdr.p_filesz, 0, phdr.p_memsz - phdr.p_filesz);
+		this->dataEnd = std::max(this->dataEnd, static_cast<int>(end));
+
+		if (!(phdr.p_flags & PF_X)) continue;
+		if (phdr.p_vaddr < text_offset || phdr.p_vaddr % 4 != 0 || phdr.p_vaddr + phdr.p_filesz > data_offset) {
+			ERROR << _file_path << ": Code must be word aligned and linked between text_offset and data_offset";
+		}
+		for (uint32_t pc = phdr.p_vaddr; pc + 4 <= phdr.p_vaddr + phdr.p_filesz; pc += 4) {
+			uint32_t word;
+			memcpy(&word, _mem + pc, sizeof(word));
+			if (this->decode(word, pc, &_imem[pc / 4])) decoded++;
+			else unknown++;
+		}
+	}
+	CLASS_INFO << decoded << " instructions decoded, " << unknown << " words left unimplemented, entry point 0x"
+	           << std::hex << ehdr.e_entry;
+	return ehdr.e_entry;
+}
+
+bool Emulator::decode(uint32_t _word, uint32_t _pc, instr* _i) {
+	*_i = instr{};
+
+	uint32_t opcode = _word & 0x7f;
+	int      rd     = (_word >> 7) & 31;
+	int      rs1    = (_word >> 15) & 31;
+	int      rs2    = (_word >> 20) & 31;
+	uint32_t funct3 = (_word >> 12) & 7;
+	uint32_t funct7 = _word >> 25;
+
+	// Immediates, sign-extended from bit 31
+	int32_t  sword = static_cast<int32_t>(_word);
+	uint32_t immI  = static_cast<uint32_t>(sword >> 20);
+	uint32_t immS  = static_cast<uint32_t>(sword >> 25 << 5) | ((_word >> 7) & 0x1f);
+	uint32_t immB  = static_cast<uint32_t>(sword >> 31 << 12) | ((_word << 4) & 0x800) | ((_word >> 20) & 0x7e0) |
+	                ((_word >> 7) & 0x1e);
+	uint32_t immJ = static_cast<uint32_t>(sword >> 31 << 20) | (_word & 0xff000) | ((_word >> 9) & 0x800) |
+	                ((_word >> 20) & 0x7fe);
+
+	// Operands follow the parser: a1 = rd (or the store data / first branch source), a2 = rs1, a3 = rs2 or imm
+	auto rType = [&](instr_type _op) {
+		_i->op     = _op;
+		_i->a1.reg = rd;
+		_i->a2.reg = rs1;
+		_i->a3.reg = rs2;
+	};
+	auto iType = [&](instr_type _op, uint32_t _imm) {
+		_i->op     = _op;
+		_i->a1.reg = rd;
+		_i->a2.reg = rs1;
+		_i->a3.imm = _imm;
+	};
+
+	switch (opcode) {
+		case 0x37:  // LUI
+		case 0x17:  // AUIPC
+			_i->op     = opcode == 0x37 ? LUI : AUIPC;
+			_i->a1.reg = rd;
+			_i->a2.imm = _word >> 12;
+			break;
+		case 0x6f:  // JAL; the target is stored as an absolute address, like a resolved label
+			_i->op     = JAL;
+			_i->a1.reg = rd;
+			_i->a2.imm = _pc + immJ;
+			break;
+		case 0x67:
+			if (funct3 == 0) iType(JALR, immI);
+			break;
+		case 0x63: {
+			static const instr_type branches[8] = {BEQ, BNE, UNIMPL, UNIMPL, BLT, BGE, BLTU, BGEU};
+			_i->op     = branches[funct3];
+			_i->a1.reg = rs1;
+			_i->a2.reg = rs2;
+			_i->a3.imm = _pc + immB;
+			break;
+		}
+		case 0x03: {
+			static const instr_type loads[8] = {LB, LH, LW, UNIMPL, LBU, LHU, UNIMPL, UNIMPL};
+			iType(loads[funct3], immI);
+			break;
+		}
+		case 0x23: {
+			static const instr_type stores[8] = {SB, SH, SW, UNIMPL, UNIMPL, UNIMPL, UNIMPL, UNIMPL};
+			_i->op     = stores[funct3];
+			_i->a1.reg = rs2;  // data
+			_i->a2.reg = rs1;  // base
+			_i->a3.imm = immS;
+			break;
+		}
+		case 0x13:
+			switch (funct3) {
+				case 0: iType(ADDI, immI); break;
+				case 2: iType(SLTI, immI); break;
+				case 3: iType(SLTIU, immI); break;
+				case 4: iType(XORI, immI); break;
+				case 6: iType(ORI, immI); break;
+				case 7: iType(ANDI, immI); break;
+				case 1:
+					if (funct7 == 0x00) iType(SLLI, rs2);
+					break;
+				case 5:
+					if (funct7 == 0x00) iType(SRLI, rs2);
+					if (funct7 == 0x20) iType(SRAI, rs2);
+					break;
+			}
+			break;
+		case 0x33: {
+			static const instr_type base[8] = {ADD, SLL, SLT, SLTU, XOR, SRL, OR, AND};
+			static const instr_type mext[8] = {MUL, MULH, MULHSU, MULHU, DIV, DIVU, REM, REMU};
+			if (funct7 == 0x00) rType(base[funct3]);
+			if (funct7 == 0x01) rType(mext[funct3]);
+			if (funct7 == 0x20 && funct3 == 0) rType(SUB);
+			if (funct7 == 0x20 && funct3 == 5) rType(SRA);
+			break;
+		}
+		case 0x0f:  // fence and fence.i; every fence is a full barrier
+			if (funct3 <= 1) _i->op = FENCE;
+			break;
+		case 0x73:  // ecall / ebreak end the program; CSR accesses are not modeled
+			if (_word == 0x00000073 || _word == 0x00100073) _i->op = HCF;
+			break;
+		case 0x2f: {  // A extension, word AMOs only (no LR/SC)
+			if (funct3 != 2) break;
+			switch (funct7 >> 2) {
+				case 0x00: rType(AMOADD_W); break;
+				case 0x01: rType(AMOSWAP_W); break;
+				case 0x04: rType(AMOXOR_W); break;
+				case 0x08: rType(AMOOR_W); break;
+				case 0x0c: rType(AMOAND_W); break;
+				case 0x10: rType(AMOMIN_W); break;
+				case 0x14: rType(AMOMAX_W); break;
+				case 0x18: rType(AMOMINU_W); break;
+				case 0x1c: rType(AMOMAXU_W); break;
+			}
+			break;
+		}
+		case 0x0b:  // custom-0: scalar CFU ops
+			if (funct3 == 0 && funct7 <= S_AMULI8I8S_VV_L - S_ADDI8I8S_VV) {
+				rType(static_cast<instr_type>(S_ADDI8I8S_VV + funct7));
+			} else if (funct3 == 1) {
+				rType(MAC4);
+				_i->a1.reg = 0;
+			} else if (funct3 == 2) {
+				rType(RDACC);
+				_i->a2.reg = 0;
+				_i->a3.reg = 0;
+			}
+			break;
+		case 0x2b:  // custom-1: vector CFU ops
+			if ((funct3 == 1 ? rs2 : rd) >= NUM_VREGS) break;
+			switch (funct3) {
+				case 0: iType(VL128, immI); break;
+				case 1:
+					_i->op     = VS128;
+					_i->a1.reg = rs2;  // vs
+					_i->a2.reg = rs1;  // base
+					_i->a3.imm = immS;
+					break;
+				case 2: rType(VMV_V_X); break;
+				case 3:
+					if (funct7 > V_AMULI8I8S_VV_L - V_ADDI8I8S_VV || rs1 >= NUM_VREGS || rs2 >= NUM_VREGS) break;
+					rType(static_cast<instr_type>(V_ADDI8I8S_VV + funct7));
+					break;
+			}
+			break;
+	}
+	return _i->op != UNIMPL;
+}
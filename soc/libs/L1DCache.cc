@@ -0,0 +1,246 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "L1DCache.hh"
+
+#include <cstring>
+
+#include "BaseMemory.hh"
+
+static int log2i(int _v) {
+	int bits = 0;
+	while ((1 << bits) < _v) bits++;
+	return bits;
+}
+
+static bool isPowerOfTwo(int _v) { return _v > 0 && (_v & (_v - 1)) == 0; }
+
+L1DCache::L1DCache(const std::string& _name, int _sets, int _ways, int _line_size, acalsim::Tick _hit_latency,
+                   ReplacementPolicy _policy)
+    : name(_name),
+      sets(_sets),
+      ways(_ways),
+      lineSize(_line_size),
+      offsetBits(log2i(_line_size)),
+      indexBits(log2i(_sets)),
+      hitLatency(_hit_latency),
+      policy(_policy) {
+	LABELED_ASSERT(isPowerOfTwo(this->sets), "L1DCache: the number of sets must be a power of two");
+	LABELED_ASSERT(isPowerOfTwo(this->lineSize) && this->lineSize >= 4,
+	               "L1DCache: the line size must be a power of two and at least 4 bytes");
+	LABELED_ASSERT(this->ways > 0, "L1DCache: the cache needs at least one way");
+	LABELED_ASSERT(this->policy != ReplacementPolicy::PLRU || (isPowerOfTwo(this->ways) && this->ways <= 32),
+	               "L1DCache: PLRU needs a power-of-two number of ways (at most 32)");
+
+	int lines = this->sets * this->ways;
+	this->tags.assign(lines, 0);
+	this->valid.assign(lines, 0);
+	this->dirty.assign(lines, 0);
+	this->lruStamp.assign(lines, 0);
+	this->data.assign((size_t)lines * this->lineSize, 0);
+	this->plruBits.assign(this->sets, 0);
+
+	LABELED_INFO(this->name) << "L1 D-cache: " << this->sets << " sets x " << this->ways << " ways x "
+	                         << this->lineSize << " B, hit latency " << this->hitLatency << ", policy "
+	                         << (this->policy == ReplacementPolicy::LRU ? "LRU" : "PLRU");
+}
+
+L1DCache::ReplacementPolicy L1DCache::parsePolicy(const std::string& _policy) {
+	if (_policy == "lru" || _policy == "LRU") return ReplacementPolicy::LRU;
+	if (_policy == "plru" || _policy == "PLRU") return ReplacementPolicy::PLRU;
+	ERROR << "L1DCache: unknown replacement policy " << _policy;
+	return ReplacementPolicy::LRU;
+}
+
+int L1DCache::findWay(uint32_t _addr) const {
+	int      set = this->setIndex(_addr);
+	uint32_t tag = this->tagOf(_addr);
+	for (int w = 0; w < this->ways; w++) {
+		int id = this->lineId(set, w);
+		if (this->valid[id] && this->tags[id] == tag) return w;
+	}
+	return -1;
+}
+
+void L1DCache::touch(int _set, int _way) {
+	this->lruStamp[this->lineId(_set, _way)] = ++this->accessCounter;
+	if (this->policy == ReplacementPolicy::PLRU && this->ways > 1) {
+		// Walk the tree from the root and make every node on the path point away from `_way`
+		int levels = log2i(this->ways);
+		int node   = 1;
+		for (int l = levels - 1; l >= 0; l--) {
+			int dir = (_way >> l) & 1;
+			if (dir) {
+				this->plruBits[_set] &= ~(1u << node);
+			} else {
+				this->plruBits[_set] |= (1u << node);
+			}
+			node = 2 * node + dir;
+		}
+	}
+}
+
+int L1DCache::selectVictim(int _set) const {
+	// Invalid ways are always used first
+	for (int w = 0; w < this->ways; w++) {
+		if (!this->valid[this->lineId(_set, w)]) return w;
+	}
+
+	if (this->policy == ReplacementPolicy::PLRU && this->ways > 1) {
+		int levels = log2i(this->ways);
+		int node   = 1;
+		int way    = 0;
+		for (int l = 0; l < levels; l++) {
+			int dir = (this->plruBits[_set] >> node) & 1;
+			way     = (way << 1) | dir;
+			node    = 2 * node + dir;
+		}
+		return way;
+	}
+
+	int      victim = 0;
+	uint64_t oldest = UINT64_MAX;
+	for (int w = 0; w < this->ways; w++) {
+		uint64_t stamp = this->lruStamp[this->lineId(_set, w)];
+		if (stamp < oldest) {
+			oldest = stamp;
+			victim = w;
+		}
+	}
+	return victim;
+}
+
+bool L1DCache::access(uint32_t _addr, bool _is_write) {
+	int way = this->findWay(_addr);
+	if (way >= 0) {
+		this->touch(this->setIndex(_addr), way);
+		if (_is_write) {
+			this->writeHits++;
+		} else {
+			this->readHits++;
+		}
+		return true;
+	}
+	if (_is_write) {
+		this->writeMisses++;
+	} else {
+		this->readMisses++;
+	}
+	return false;
+}
+
+uint32_t L1DCache::read(uint32_t _addr, size_t _bytes) {
+	int way = this->findWay(_addr);
+	LABELED_ASSERT(way >= 0, "L1DCache::read() on a line that is not resident");
+	uint32_t offset = _addr & (this->lineSize - 1);
+	LABELED_ASSERT(offset + _bytes <= (size_t)this->lineSize, "L1DCache: access crosses a cache line");
+
+	uint32_t ret = 0;
+	std::memcpy(&ret, &this->data[(size_t)this->lineId(this->setIndex(_addr), way) * this->lineSize + offset], _bytes);
+	return ret;
+}
+
+void L1DCache::write(uint32_t _addr, size_t _bytes, uint32_t _data) {
+	int way = this->findWay(_addr);
+	LABELED_ASSERT(way >= 0, "L1DCache::write() on a line that is not resident");
+	uint32_t offset = _addr & (this->lineSize - 1);
+	LABELED_ASSERT(offset + _bytes <= (size_t)this->lineSize, "L1DCache: access crosses a cache line");
+
+	int id = this->lineId(this->setIndex(_addr), way);
+	std::memcpy(&this->data[(size_t)id * this->lineSize + offset], &_data, _bytes);
+	this->dirty[id] = 1;
+}
+
+L1DCache::Victim L1DCache::beginMiss(uint32_t _addr) {
+	LABELED_ASSERT(this->fillWay < 0, "L1DCache supports a single outstanding miss");
+	int set = this->setIndex(_addr);
+	int way = this->selectVictim(set);
+	int id  = this->lineId(set, way);
+
+	Victim victim;
+	if (this->valid[id] && this->dirty[id]) {
+		victim.writeback = true;
+		victim.lineAddr  = (this->tags[id] << (this->offsetBits + this->indexBits)) | (set << this->offsetBits);
+		victim.words.resize(this->getWordsPerLine());
+		std::memcpy(victim.words.data(), &this->data[(size_t)id * this->lineSize], this->lineSize);
+		this->writebacks++;
+	}
+
+	// The way now belongs to the incoming line; it becomes valid once every beat has arrived
+	this->valid[id] = 0;
+	this->dirty[id] = 0;
+	this->tags[id]  = this->tagOf(_addr);
+	this->fillSet   = set;
+	this->fillWay   = way;
+	this->fillWords = 0;
+	return victim;
+}
+
+bool L1DCache::fillWord(int _word_idx, uint32_t _data) {
+	LABELED_ASSERT(this->fillWay >= 0, "L1DCache received a fill beat without an outstanding miss");
+	int id = this->lineId(this->fillSet, this->fillWay);
+	std::memcpy(&this->data[(size_t)id * this->lineSize + _word_idx * 4], &_data, 4);
+
+	if (++this->fillWords < this->getWordsPerLine()) return false;
+
+	this->valid[id] = 1;
+	this->touch(this->fillSet, this->fillWay);
+	this->fillSet = -1;
+	this->fillWay = -1;
+	return true;
+}
+
+L1DCache::Victim L1DCache::invalidate(uint32_t _addr) {
+	Victim victim;
+	int    way = this->findWay(_addr);
+	if (way < 0) return victim;
+
+	int id = this->lineId(this->setIndex(_addr), way);
+	if (this->dirty[id]) {
+		victim.writeback = true;
+		victim.lineAddr  = this->lineBase(_addr);
+		victim.words.resize(this->getWordsPerLine());
+		std::memcpy(victim.words.data(), &this->data[(size_t)id * this->lineSize], this->lineSize);
+		this->writebacks++;
+	}
+	this->valid[id] = 0;
+	this->dirty[id] = 0;
+	return victim;
+}
+
+void L1DCache::flush(BaseMemory* _mem) {
+	for (int set = 0; set < this->sets; set++) {
+		for (int way = 0; way < this->ways; way++) {
+			int id = this->lineId(set, way);
+			if (!this->valid[id] || !this->dirty[id]) continue;
+			uint32_t lineAddr = (this->tags[id] << (this->offsetBits + this->indexBits)) | (set << this->offsetBits);
+			_mem->writeData(&this->data[(size_t)id * this->lineSize], lineAddr, this->lineSize);
+			this->dirty[id] = 0;
+		}
+	}
+}
+
+void L1DCache::printStats() const {
+	uint64_t hits     = this->readHits + this->writeHits;
+	uint64_t misses   = this->readMisses + this->writeMisses;
+	uint64_t accesses = hits + misses;
+	double   hitRate  = accesses ? (double)hits / (double)accesses : 0.0;
+
+	LABELED_INFO(this->name) << "L1 D-cache stats: accesses " << accesses << ", read hits " << this->readHits
+	                         << ", read misses " << this->readMisses << ", write hits " << this->writeHits
+	                         << ", write misses " << this->writeMisses << ", write-backs " << this->writebacks
+	                         << ", hit rate " << hitRate * 100.0 << "%";
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyHistogram.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+size_t LatencyHistogram::bucketOf(acalsim::Tick _latency) {
+	_latency  = std::min(_latency, kMaxTracked);
+	int shift = std::max(0, static_cast<int>(std::bit_width(_latency)) - (kSubBits + 1));
+	// shift 0 covers [0, 32) one tick per bucket; shift s > 0 maps [16 << s, 32 << s) onto 16 buckets
+	return (static_cast<size_t>(shift) << kSubBits) + static_cast<size_t>(_latency >> shift);
+}
+
+acalsim::Tick LatencyHistogram::upperBound(size_t _bucket) {
+	size_t sub   = size_t{1} << kSubBits;
+	size_t shift = _bucket < 2 * sub ? 0 : _bucket / sub - 1;
+	size_t mant  = _bucket - (shift << kSubBits);
+	return ((static_cast<acalsim::Tick>(mant) + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(acalsim::Tick _latency) {
+	this->buckets[bucketOf(_latency)]++;
+	this->samples++;
+	this->maxSample = std::max(this->maxSample, _latency);
+}
+
+acalsim::Tick LatencyHistogram::percentile(double _p) const {
+	if (this->samples == 0) return 0;
+	uint64_t rank = std::clamp<uint64_t>((uint64_t)std::ceil(_p * (double)this->samples), 1, this->samples);
+	uint64_t seen = 0;
+	for (size_t b = 0; b < kNumBuckets; b++) {
+		seen += this->buckets[b];
+		if (seen >= rank) return std::min(upperBound(b), this->maxSample);
+	}
+	return this->maxSample;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedFile.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const std::string& _path) {
+	this->close();
+	int fd = ::open(_path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	bool        ok = fstat(fd, &st) == 0;
+	if (ok && st.st_size > 0) {
+		void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		ok         = base != MAP_FAILED;
+		if (ok) {
+			this->base   = base;
+			this->length = st.st_size;
+		}
+	}
+	::close(fd);
+	return ok;
+}
+
+void MappedFile::close() {
+	if (this->base) munmap(this->base, this->length);
+	this->base   = nullptr;
+	this->length = 0;
+}
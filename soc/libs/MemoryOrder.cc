@@ -0,0 +1,40 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MemoryOrder.hh"
+
+#include <algorithm>
+
+acalsim::Tick MemoryOrder::schedule(acalsim::Tick _now, acalsim::Tick _ready, uint32_t _addr, uint32_t _bytes,
+                                    bool _write) {
+	uint64_t      begin = _addr;
+	uint64_t      end   = begin + _bytes;
+	acalsim::Tick when  = _ready;
+
+	// Drop the beats that have been performed while looking for conflicts among the others
+	size_t kept = 0;
+	for (size_t n = 0; n < this->numBeats; n++) {
+		const Beat& beat = this->beats[n];
+		if (beat.when < _now) continue;
+		if ((_write || beat.write) && beat.begin < end && begin < beat.end) { when = std::max(when, beat.when); }
+		this->beats[kept++] = beat;
+	}
+	this->numBeats = kept;
+
+	LABELED_ASSERT(this->numBeats < kMaxBeats, "MemoryOrder: too many beats in flight");
+	this->beats[this->numBeats++] = {when, begin, end, _write};
+	return when;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NoC.hh"
+
+#include <algorithm>
+
+NoCModel::Kind NoCModel::parseKind(const std::string& _kind) {
+	if (_kind == "crossbar") return Kind::CROSSBAR;
+	if (_kind == "mesh") return Kind::MESH;
+	if (_kind == "ring") return Kind::RING;
+	ERROR << "NoCModel: unknown interconnect " << _kind;
+	return Kind::CROSSBAR;
+}
+
+const char* NoCModel::kindName(Kind _kind) {
+	switch (_kind) {
+		case Kind::CROSSBAR: return "crossbar";
+		case Kind::MESH: return "mesh";
+		case Kind::RING: return "ring";
+	}
+	return "unknown";
+}
+
+void NoCModel::build(Kind _kind, size_t _cols, size_t _rows, acalsim::Tick _router_latency, size_t _link_width,
+                     std::vector<size_t> _master_nodes, std::vector<size_t> _slave_nodes) {
+	this->kind = _kind;
+	if (!this->enabled()) return;
+
+	LABELED_ASSERT(_cols > 0 && _rows > 0, "NoCModel: the router grid must not be empty");
+	LABELED_ASSERT(_link_width > 0, "NoCModel: link_width must be at least one byte");
+	size_t num_nodes = _cols * _rows;
+	for (size_t node : _master_nodes) {
+		if (node >= num_nodes) { ERROR << "NoCModel: master placed on router " << node << " outside the grid"; }
+	}
+	for (size_t node : _slave_nodes) {
+		if (node >= num_nodes) { ERROR << "NoCModel: slave placed on router " << node << " outside the grid"; }
+	}
+
+	this->cols          = _cols;
+	this->rows          = _rows;
+	this->routerLatency = _router_latency;
+	this->linkWidth     = _link_width;
+	this->masterNodes   = std::move(_master_nodes);
+	this->slaveNodes    = std::move(_slave_nodes);
+	this->linkFree.assign(num_nodes * NUM_DIRS, 0);
+	this->linkFlits.assign(num_nodes * NUM_DIRS, 0);
+
+	LABELED_INFO("NoCModel") << kindName(this->kind) << " " << this->cols << "x" << this->rows << ", router latency "
+	                         << this->routerLatency << " ticks, " << this->linkWidth << "-byte links";
+}
+
+NoCModel::Dir NoCModel::route(size_t _at, size_t _dst) const {
+	if (_at == _dst) return NUM_DIRS;
+	if (this->kind == Kind::RING) {
+		size_t num_nodes = this->cols * this->rows;
+		size_t cw        = (_dst + num_nodes - _at) % num_nodes;
+		return cw <= num_nodes - cw ? EAST : WEST;
+	}
+	// XY routing: resolve the column first, then the row
+	size_t x = _at % this->cols, dst_x = _dst % this->cols;
+	if (x != dst_x) return x < dst_x ? EAST : WEST;
+	return _at / this->cols > _dst / this->cols ? NORTH : SOUTH;
+}
+
+size_t NoCModel::neighbor(size_t _at, Dir _dir) const {
+	size_t num_nodes = this->cols * this->rows;
+	switch (_dir) {
+		case EAST: return this->kind == Kind::RING ? (_at + 1) % num_nodes : _at + 1;
+		case WEST: return this->kind == Kind::RING ? (_at + num_nodes - 1) % num_nodes : _at - 1;
+		case NORTH: return _at - this->cols;
+		case SOUTH: return _at + this->cols;
+		default: return _at;
+	}
+}
+
+acalsim::Tick NoCModel::traverse(size_t _src, size_t _dst, size_t _bytes, acalsim::Tick _inject) {
+	acalsim::Tick flits = (std::max<size_t>(_bytes, 1) + this->linkWidth - 1) / this->linkWidth;
+
+	// `head` is the tick the head flit is ready to leave the current router
+	acalsim::Tick head = _inject + this->routerLatency;
+	size_t        hops = 0;
+	for (size_t at = _src; at != _dst; hops++) {
+		Dir           dir   = this->route(at, _dst);
+		size_t        link  = at * NUM_DIRS + dir;
+		acalsim::Tick start = std::max(head, this->linkFree[link]);
+		this->totalStall += start - head;
+		this->linkFree[link] = start + flits;
+		this->linkFlits[link] += flits;
+		at   = this->neighbor(at, dir);
+		head = start + 1 + this->routerLatency;
+	}
+
+	acalsim::Tick arrival = head + flits - 1;
+	this->packets++;
+	this->totalHops += hops;
+	this->totalLatency += arrival - _inject;
+	this->maxLatency    = std::max(this->maxLatency, arrival - _inject);
+	this->lastDelivered = std::max(this->lastDelivered, arrival);
+	return arrival;
+}
+
+void NoCModel::report() const {
+	if (!this->enabled() || this->packets == 0) return;
+	LABELED_INFO("NoCModel") << kindName(this->kind) << ": " << this->packets << " packets, avg "
+	                         << (double)this->totalHops / (double)this->packets << " hops, avg latency "
+	                         << (double)this->totalLatency / (double)this->packets << " ticks, max "
+	                         << this->maxLatency << " ticks, " << this->totalStall << " ticks stalled on busy links";
+
+	static const char* dirNames[] = {"east", "west", "north", "south"};
+	double             elapsed    = (double)std::max<acalsim::Tick>(this->lastDelivered, 1);
+	for (size_t link = 0; link < this->linkFlits.size(); link++) {
+		if (this->linkFlits[link] == 0) continue;
+		LABELED_INFO("NoCModel") << "router " << link / NUM_DIRS << " " << dirNames[link % NUM_DIRS] << ": "
+		                         << this->linkFlits[link] << " flits, utilization "
+		                         << (double)this->linkFlits[link] / elapsed;
+	}
+}
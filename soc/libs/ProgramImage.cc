@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProgramImage.hh"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+uint64_t ProgramImage::hash(const void* _data, size_t _len, uint64_t _seed) {
+	// FNV-1a over whole words, folding the high half back down so every byte reaches every bit
+	const uint8_t* bytes = static_cast<const uint8_t*>(_data);
+	uint64_t       h     = _seed;
+	size_t         i     = 0;
+	for (; i + sizeof(uint64_t) <= _len; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(word));
+		h = (h ^ word) * 0x100000001b3ull;
+		h ^= h >> 32;
+	}
+	for (; i < _len; i++) h = (h ^ bytes[i]) * 0x100000001b3ull;
+	return h;
+}
+
+bool ProgramImage::map(const std::string& _path, uint64_t _key) {
+	this->unmap();
+	if (!this->file.open(_path) || this->file.size() < sizeof(Header)) {
+		this->unmap();
+		return false;
+	}
+
+	// Hand out the sections in the order write() laid them down; nullptr once the file runs short
+	const char* bytes = this->file.data();
+	size_t      size  = this->file.size();
+	size_t      at    = 0;
+
+	auto take = [&](size_t _len) -> const char* {
+		at = (at + 7) & ~size_t{7};
+		if (at > size || _len > size - at) return nullptr;
+		const char* section = bytes + at;
+		at += _len;
+		return section;
+	};
+
+	Header header;
+	memcpy(&header, take(sizeof(header)), sizeof(header));
+	if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+	    header.instrSize != sizeof(instr) || header.key != _key || header.fileSize != size) {
+		this->unmap();
+		return false;
+	}
+
+	auto imem     = take(size_t{header.numInstrs} * sizeof(instr));
+	auto segments = take(size_t{header.numSegments} * sizeof(SegmentEntry));
+	auto symbols  = take(size_t{header.numSymbols} * sizeof(SymbolEntry));
+	if (!imem || !segments || !symbols) {
+		this->unmap();
+		return false;
+	}
+	this->view.imem = {reinterpret_cast<const instr*>(imem), header.numInstrs};
+	for (uint32_t n = 0; n < header.numSegments; n++) {
+		SegmentEntry entry;
+		memcpy(&entry, segments + n * sizeof(entry), sizeof(entry));
+		auto data = take(entry.size);
+		if (!data) {
+			this->unmap();
+			return false;
+		}
+		this->view.segments.push_back({entry.addr, {reinterpret_cast<const uint8_t*>(data), entry.size}});
+	}
+	auto names = take(header.nameBytes);
+	if (!names) {
+		this->unmap();
+		return false;
+	}
+	for (uint32_t n = 0; n < header.numSymbols; n++) {
+		SymbolEntry entry;
+		memcpy(&entry, symbols + n * sizeof(entry), sizeof(entry));
+		if (entry.nameOffset > header.nameBytes || entry.nameLen > header.nameBytes - entry.nameOffset) {
+			this->unmap();
+			return false;
+		}
+		this->view.symbols.emplace_back(std::string_view(names + entry.nameOffset, entry.nameLen), entry.loc);
+	}
+	this->view.memoff  = header.memoff;
+	this->view.dataEnd = header.dataEnd;
+	return true;
+}
+
+bool ProgramImage::write(const std::string& _path, uint64_t _key, const Contents& _contents) {
+	std::vector<SegmentEntry> segments;
+	for (const Segment& segment : _contents.segments) {
+		segments.push_back({segment.addr, static_cast<uint32_t>(segment.bytes.size())});
+	}
+	std::vector<SymbolEntry> symbols;
+	std::string              names;
+	for (const auto& [name, loc] : _contents.symbols) {
+		symbols.push_back({loc, static_cast<uint32_t>(names.size()), static_cast<uint32_t>(name.size())});
+		names.append(name);
+	}
+
+	Header header{};
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version     = kVersion;
+	header.instrSize   = sizeof(instr);
+	header.key         = _key;
+	header.numInstrs   = _contents.imem.size();
+	header.numSegments = segments.size();
+	header.numSymbols  = symbols.size();
+	header.nameBytes   = names.size();
+	header.memoff      = _contents.memoff;
+	header.dataEnd     = _contents.dataEnd;
+
+	// Lay the sections out exactly as map() takes them; the file size is patched in last
+	std::vector<char> out;
+
+	auto put = [&out](const void* _data, size_t _len) {
+		out.resize((out.size() + 7) & ~size_t{7});
+		out.insert(out.end(), static_cast<const char*>(_data), static_cast<const char*>(_data) + _len);
+	};
+	put(&header, sizeof(header));
+	put(_contents.imem.data(), _contents.imem.size_bytes());
+	put(segments.data(), segments.size() * sizeof(SegmentEntry));
+	put(symbols.data(), symbols.size() * sizeof(SymbolEntry));
+	for (const Segment& segment : _contents.segments) { put(segment.bytes.data(), segment.bytes.size()); }
+	put(names.data(), names.size());
+	header.fileSize = out.size();
+	memcpy(out.data(), &header, sizeof(header));
+
+	// Runs that race on the same image each rename a complete file over it
+	std::string tmp_path = _path + ".tmp." + std::to_string(getpid());
+	FILE*       fout     = fopen(tmp_path.c_str(), "wb");
+	if (!fout) return false;
+	bool ok = fwrite(out.data(), 1, out.size(), fout) == out.size();
+	ok      = fclose(fout) == 0 && ok;
+	if (!ok || rename(tmp_path.c_str(), _path.c_str()) != 0) {
+		remove(tmp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+void ProgramImage::unmap() {
+	this->file.close();
+	this->view = Contents{};
+}
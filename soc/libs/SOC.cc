@@ -1 +1,187 @@
-#include "SOC.hh"
\ No newline at end of file
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SOC.hh"
+
+#include <algorithm>
+#include <set>
+
+void SOC::registerSimulators() {
+	// Get the maximal memory footprint size in the Emulator Configuration
+	size_t mem_size = acalsim::top->getParameter<int>("Emulator", "memory_size");
+
+	auto specs   = acalsim::top->getParameter<std::vector<DeviceSpec>>("Topology", "devices");
+	auto masters = acalsim::top->getParameter<std::vector<std::string>>("Topology", "masters");
+	auto slaves  = acalsim::top->getParameter<std::vector<std::string>>("Topology", "slaves");
+
+	// Instruction Set Architecture Emulator (Functional Model)
+	this->isaEmulator = new Emulator("RISCV RV32I Emulator");
+
+	for (const auto& spec : specs) {
+		LABELED_ASSERT(!this->devices.count(spec.name), "Topology: duplicated device name");
+		LABELED_ASSERT(spec.qos >= 0 && spec.qos <= 255, "Topology: qos must be within [0, 255]");
+		this->devices[spec.name]     = this->createDevice(spec, mem_size);
+		this->devices[spec.name].qos = static_cast<uint8_t>(spec.qos);
+	}
+	LABELED_ASSERT(this->dmem, "Topology: the SoC needs exactly one memory device");
+	LABELED_ASSERT(!this->cpus.empty(), "Topology: the SoC needs at least one cpu device");
+	// The private write-back caches are not kept coherent, so shared data would lose updates
+	LABELED_ASSERT(this->cpus.size() == 1 || !acalsim::top->getParameter<int>("L1DCache", "enable"),
+	               "Topology: L1DCache.enable requires a single cpu device");
+
+	auto lookup = [this](const std::string& _name) -> BusDevice& {
+		auto it = this->devices.find(_name);
+		if (it == this->devices.end()) { ERROR << "Topology: unknown device " << _name; }
+		return it->second;
+	};
+
+	// The memory keeps one request queue per master
+	this->dmem->setNumMasters(masters.size());
+
+	// XBar
+	this->XBar = new acalsim::crossbar::CrossBar("CrossBar", masters.size(), slaves.size());
+	this->addSimulator(this->XBar);
+
+	// Bus identities: a master ID is the request port index, a slave ID the response port index
+	for (size_t i = 0; i < masters.size(); i++) {
+		BusDevice& dev = lookup(masters[i]);
+		MasterID   id  = MasterRegistry::registerMaster(masters[i]);
+		LABELED_ASSERT(id == i, "Topology: master IDs must follow the order of the masters list");
+		dev.bus->setMasterID(id);
+	}
+	for (size_t i = 0; i < slaves.size(); i++) {
+		BusDevice& dev = lookup(slaves[i]);
+		LABELED_ASSERT(!dev.respPort.empty(), "Topology: the device cannot be attached as a bus slave");
+		dev.bus->setSlaveID(i);
+	}
+
+	LABELED_ASSERT(std::find(slaves.begin(), slaves.end(), this->dmem->getName()) != slaves.end(),
+	               "Topology: the memory device must be attached as a bus slave");
+
+	// Address decoding shared by every master
+	this->addressMap.build(acalsim::top->getParameter<std::vector<AddressRegion>>("AddressMap", "regions"),
+	                       acalsim::top->getParameter<int>("AddressMap", "default_slave"), slaves.size());
+
+	// A systolic array loads its operands by programming the DMA through the DMA's MMIO window
+	if (!this->systolicArrays.empty()) {
+		LABELED_ASSERT(this->dmas.size() == 1, "Topology: a systolic_array device needs exactly one dma device");
+		LABELED_ASSERT(std::find(slaves.begin(), slaves.end(), this->dmas[0]->getName()) != slaves.end(),
+		               "Topology: the dma device must be attached as a bus slave");
+		const AddressRegion* window = this->addressMap.findSlave(this->dmas[0]->getSlaveID());
+		LABELED_ASSERT(window, "AddressMap: no region is routed to the dma device");
+		for (auto sa : this->systolicArrays) { sa->setDMABase(window->base); }
+	}
+
+	// Router placement: explicit `node` entries first, the other devices fill the lowest free routers in order
+	std::set<size_t> taken;
+	for (const auto& spec : specs) {
+		if (spec.node >= 0) { taken.insert(spec.node); }
+	}
+	size_t next_node = 0;
+	for (const auto& spec : specs) {
+		if (spec.node >= 0) {
+			this->devices[spec.name].node = spec.node;
+			continue;
+		}
+		while (taken.count(next_node)) { next_node++; }
+		this->devices[spec.name].node = next_node;
+		taken.insert(next_node);
+	}
+	std::vector<size_t> master_nodes, slave_nodes;
+	for (const auto& name : masters) { master_nodes.push_back(lookup(name).node); }
+	for (const auto& name : slaves) { slave_nodes.push_back(lookup(name).node); }
+	this->noc.build(NoCModel::parseKind(acalsim::top->getParameter<std::string>("Topology", "interconnect")),
+	                acalsim::top->getParameter<int>("Topology", "noc_cols"),
+	                acalsim::top->getParameter<int>("Topology", "noc_rows"),
+	                acalsim::top->getParameter<acalsim::Tick>("Topology", "router_latency"),
+	                acalsim::top->getParameter<int>("Topology", "link_width"), master_nodes, slave_nodes);
+
+	// still add those upstream & downstream
+	// Keep the dump memory functional
+	this->XBar->addDownStream(this->dmem, "DSDMem");
+	for (auto cpu : this->cpus) { cpu->addDownStream(this->XBar, "DSBus"); }
+
+	// master construction
+	for (const auto& name : masters) {
+		BusDevice& dev = lookup(name);
+		MasterID   id  = dev.bus->getMasterID();
+		dev.bus->setAddressMap(&this->addressMap);
+		dev.bus->setMemorySlave(this->dmem->getSlaveID());
+		dev.bus->setQoS(dev.qos);
+		dev.bus->setNoC(&this->noc);
+		// Register PRMasterPort to Masters in `SimTop`
+		dev.sim->addPRMasterPort("bus-m", this->XBar->getPipeRegister("Req", id));
+		// Simport Connection (Bus <> SlavePort at Devices) for the response channel
+		for (auto mp : this->XBar->getMasterPortsBySlave("Resp", id)) {
+			acalsim::SimPortManager::ConnectPort(this->XBar, dev.sim, mp->getName(), "bus-s");
+		}
+	}
+
+	// slave construction
+	for (const auto& name : slaves) {
+		BusDevice& dev = lookup(name);
+		size_t     id  = dev.bus->getSlaveID();
+		dev.bus->setNoC(&this->noc);
+		// Make SimPort Connection to Slaves in `SimTop`
+		for (auto mp : this->XBar->getMasterPortsBySlave("Req", id)) {
+			acalsim::SimPortManager::ConnectPort(this->XBar, dev.sim, mp->getName(), "bus-s");
+		}
+		// Register PRMasterPort to Slaves for the response channel
+		dev.sim->addPRMasterPort(dev.respPort, this->XBar->getPipeRegister("Resp", id));
+	}
+}
+
+SOC::BusDevice SOC::createDevice(const DeviceSpec& _spec, size_t _mem_size) {
+	if (_spec.type == "cpu") {
+		// CPU Timing Model and its private CFU
+		auto cpu = new CPU(_spec.name, this->isaEmulator);
+		cpu->setHartID(this->cpus.size());
+		auto cfu = new CFU(_spec.name + "-CFU");
+		this->addSimulator(cpu);
+		this->addSimulator(cfu);
+		cpu->addDownStream(cfu, "DSCFU");
+		cfu->addUpStream(cpu, "USCPU");
+		// channel cpu <-> cfu
+		ChannelPortManager::ConnectPort(cpu, cfu, cpu->getName() + "-m_cfu", cfu->getName() + "-s_cpu");
+		ChannelPortManager::ConnectPort(cfu, cpu, cfu->getName() + "-m_cpu", cpu->getName() + "-s_cfu");
+		this->cpus.push_back(cpu);
+		this->cpuPrograms.push_back(_spec.program);
+		return {cpu, cpu, ""};
+	}
+	if (_spec.type == "memory") {
+		// Data Memory Timing Model
+		LABELED_ASSERT(!this->dmem, "Topology: only one memory device is supported");
+		this->dmem = new DataMemory(_spec.name, _mem_size);
+		if (!_spec.arbiter.empty()) { this->dmem->setArbiter(BusArbiter::parsePolicy(_spec.arbiter)); }
+		this->addSimulator(this->dmem);
+		return {this->dmem, this->dmem, "bus-m"};
+	}
+	if (_spec.type == "dma") {
+		// DMA Controller; "bus-m" is taken by its request port
+		auto dma = new DMAController(_spec.name);
+		this->addSimulator(dma);
+		this->dmas.push_back(dma);
+		return {dma, dma, "bus-m-2"};
+	}
+	if (_spec.type == "systolic_array") {
+		auto sa = new SystolicArray(_spec.name);
+		this->addSimulator(sa);
+		this->systolicArrays.push_back(sa);
+		return {sa, sa, "bus-m-2"};
+	}
+	ERROR << "Topology: unknown device type " << _spec.type << " for " << _spec.name;
+	return {};
+}
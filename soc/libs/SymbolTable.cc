@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SymbolTable.hh"
+
+SymbolTable::SymbolID SymbolTable::intern(std::string_view _name) {
+	if (auto it = this->ids.find(_name); it != this->ids.end()) return it->second;
+	SymbolID id = static_cast<SymbolID>(this->names.size());
+	this->names.emplace_back(_name);
+	this->ids.emplace(this->names.back(), id);
+	this->locs.push_back(-1);
+	return id;
+}
+
+bool SymbolTable::define(SymbolID _id, uint32_t _loc) {
+	if (this->isDefined(_id)) return false;
+	this->locs[_id] = _loc;
+	return true;
+}
+
+void SymbolTable::reserve(size_t _count) {
+	this->ids.reserve(_count);
+	this->locs.reserve(_count);
+}
+
+void SymbolTable::clear() {
+	this->ids.clear();
+	this->names.clear();
+	this->locs.clear();
+}
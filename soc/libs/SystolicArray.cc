@@ -1,10 +1,16 @@
 #include "SystolicArray.hh"
 
 #include <algorithm>
-SystolicArray::SystolicArray(const std::string& name) : acalsim::CPPSimBase(name) {
+#include <cstring>
+SystolicArray::SystolicArray(const std::string& name)
+    : acalsim::CPPSimBase(name), sram_(SA_SRAM_SIZE * sizeof(uint32_t)) {
 	LABELED_INFO(this->getName()) << "Constructing SystolicArray...";
 	// register the slave port for MMIO
 	this->addSlavePort("bus-s", 1);
+	busHandlers_.on<&SystolicArray::handleReadRequest>();
+	busHandlers_.on<&SystolicArray::handleWriteRequest>();
+	busHandlers_.on<&SystolicArray::handleReadResponse>();
+	busHandlers_.on<&SystolicArray::handleWriteCompletion>();
 }
 
 SystolicArray::~SystolicArray() {}
@@ -20,89 +26,84 @@ void SystolicArray::step() {
 	if (!req_Q_.empty() || !resp_Q_.empty()) { trySendPacket(); }
 
 	// Handle incoming packets on slave ports
-	auto rc = acalsim::top->getRecycleContainer();
 	for (auto& sp : this->s_ports_) {
 		if (!sp.second->isPopValid()) continue;
-		auto pkt            = sp.second->pop();
-		int  delay_lentency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
-		/* READ‑REQUEST ------------------------------------------------ */
-		if (auto rd = dynamic_cast<XBarMemReadReqPacket*>(pkt)) {
-			assert(rd->getPayloads().size() == rd->getBurstSize());
-			auto payload = rd->getPayloads();
-			auto addr0   = payload[0]->getAddr();
-
-			/* decide MMIO vs. on‑chip SRAM */
-			bool toSram = (addr0 >= SA_MEMORY_BASE && addr0 < SA_MEMORY_BASE + SA_SRAM_SIZE);
-
-			/* prepare burst tracker */
-			pending_[rd->getAutoIncTID()].expected = payload.size();
-			if (toSram) {
-				for (int i = 0; i < rd->getBurstSize(); i++) {
-					acalsim::LambdaEvent<void()>* event =
-					    new acalsim::LambdaEvent<void()>([this, i, payload, delay_lentency]() {
-						    this->SRAMReadReqHandler(acalsim::top->getGlobalTick() + i + delay_lentency, payload[i]);
-					    });
-					this->scheduleEvent(event, acalsim::top->getGlobalTick() + i + delay_lentency);
-				}
-			} else { /* legacy MMIO path (unchanged) */
-				assert(payload.size() == 1);
-				acalsim::LambdaEvent<void()>* event =
-				    new acalsim::LambdaEvent<void()>([this, payload, delay_lentency]() {
-					    this->readMMIO(acalsim::top->getGlobalTick() + delay_lentency, payload[0]);
-				    });
-				this->scheduleEvent(event, acalsim::top->getGlobalTick() + delay_lentency);
-			}
-			rc->recycle(rd);
-		}
-		/* WRITE‑REQUEST --------------------------------------------- */
-		else if (auto wr = dynamic_cast<XBarMemWriteReqPacket*>(pkt)) {
-			assert(wr->getPayloads().size() == wr->getBurstSize());
-			auto payload = wr->getPayloads();
-			auto addr0   = payload[0]->getAddr();
-			bool toSram  = (addr0 >= SA_MEMORY_BASE && addr0 < SA_MEMORY_BASE + SA_SRAM_SIZE);
-
-			pending_[wr->getAutoIncTID()].expected = payload.size();
-
-			if (toSram) {
-				for (int i = 0; i < wr->getBurstSize(); i++) {
-					acalsim::LambdaEvent<void()>* event =
-					    new acalsim::LambdaEvent<void()>([this, i, payload, delay_lentency]() {
-						    this->SRAMWriteReqHandler(acalsim::top->getGlobalTick() + i + delay_lentency, payload[i]);
-					    });
-					this->scheduleEvent(event, acalsim::top->getGlobalTick() + i + delay_lentency);
-				}
-			} else {
-				assert(payload.size() == 1);
-				acalsim::LambdaEvent<void()>* event =
-				    new acalsim::LambdaEvent<void()>([this, payload, delay_lentency]() {
-					    this->writeMMIO(acalsim::top->getGlobalTick() + delay_lentency, payload[0]);
-				    });
-				this->scheduleEvent(event, acalsim::top->getGlobalTick() + delay_lentency);
-			}
-			rc->recycle(wr);
+		auto pkt = static_cast<XBarPacket*>(sp.second->pop());
+		this->onArrival(this, pkt);
+	}
+}
+
+void SystolicArray::receiveBusPacket(XBarPacket* pkt) {
+	this->completeTransaction(pkt);
+	if (!busHandlers_.dispatch(this, pkt)) { CLASS_ERROR << "Unknown packet type in SystolicArray::step"; }
+	if (!req_Q_.empty()) { trySendPacket(); }
+}
+
+/* READ‑REQUEST ------------------------------------------------ */
+void SystolicArray::handleReadRequest(XBarMemReadReqPacket* pkt) {
+	int delay_lentency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
+	assert(pkt->getPayloads().size() == pkt->getBurstSize());
+	auto payload = pkt->getPayloads();
+	auto addr0   = payload[0]->getAddr();
+
+	/* decide MMIO vs. on‑chip SRAM */
+	bool toSram = (addr0 >= SA_MEMORY_BASE && addr0 < SA_MEMORY_BASE + SA_SRAM_SIZE);
+
+	/* prepare burst tracker */
+	pending_[pkt->getAutoIncTID()].expected = payload.size();
+	if (toSram) {
+		for (int i = 0; i < pkt->getBurstSize(); i++) {
+			acalsim::LambdaEvent<void()>* event =
+			    new acalsim::LambdaEvent<void()>([this, i, beat = payload[i], delay_lentency]() {
+				    this->SRAMReadReqHandler(acalsim::top->getGlobalTick() + i + delay_lentency, beat);
+			    });
+			this->scheduleEvent(event, acalsim::top->getGlobalTick() + i + delay_lentency);
 		}
-		/* RESPONSE packets coming back from *downstream* ------------ */
-		else if (auto rresp = dynamic_cast<XBarMemReadRespPacket*>(pkt)) {
-			handleReadResponse(rresp);
-		} else if (auto wresp = dynamic_cast<XBarMemWriteRespPacket*>(pkt)) {
-			handleWriteCompletion(wresp);
-		} else {
-			CLASS_ERROR << "Unknown packet type in SystolicArray::step";
+	} else { /* legacy MMIO path (unchanged) */
+		assert(payload.size() == 1);
+		acalsim::LambdaEvent<void()>* event =
+		    new acalsim::LambdaEvent<void()>([this, beat = payload[0], delay_lentency]() {
+			    this->readMMIO(acalsim::top->getGlobalTick() + delay_lentency, beat);
+		    });
+		this->scheduleEvent(event, acalsim::top->getGlobalTick() + delay_lentency);
+	}
+	acalsim::top->getRecycleContainer()->recycle(pkt);
+}
+
+/* WRITE‑REQUEST --------------------------------------------- */
+void SystolicArray::handleWriteRequest(XBarMemWriteReqPacket* pkt) {
+	int delay_lentency = acalsim::top->getParameter<acalsim::Tick>("SOC", "memory_read_latency");
+	assert(pkt->getPayloads().size() == pkt->getBurstSize());
+	auto payload = pkt->getPayloads();
+	auto addr0   = payload[0]->getAddr();
+	bool toSram  = (addr0 >= SA_MEMORY_BASE && addr0 < SA_MEMORY_BASE + SA_SRAM_SIZE);
+
+	pending_[pkt->getAutoIncTID()].expected = payload.size();
+
+	if (toSram) {
+		for (int i = 0; i < pkt->getBurstSize(); i++) {
+			acalsim::LambdaEvent<void()>* event =
+			    new acalsim::LambdaEvent<void()>([this, i, beat = payload[i], delay_lentency]() {
+				    this->SRAMWriteReqHandler(acalsim::top->getGlobalTick() + i + delay_lentency, beat);
+			    });
+			this->scheduleEvent(event, acalsim::top->getGlobalTick() + i + delay_lentency);
 		}
-	}
+	} else {
+		assert(payload.size() == 1);
+		acalsim::LambdaEvent<void()>* event =
+		    new acalsim::LambdaEvent<void()>([this, beat = payload[0], delay_lentency]() {
+			    this->writeMMIO(acalsim::top->getGlobalTick() + delay_lentency, beat);
+		    });
+		this->scheduleEvent(event, acalsim::top->getGlobalTick() + delay_lentency);
+	}
+	acalsim::top->getRecycleContainer()->recycle(pkt);
 }
 
 void SystolicArray::trySendPacket() {
 	// request channel
-	if (!req_Q_.empty() && !m_req_->isStalled()) {
-		m_req_->push(req_Q_.front());
-		req_Q_.pop();
-	}
+	if (!req_Q_.empty() && this->pushRequest(m_req_, static_cast<XBarPacket*>(req_Q_.front()))) { req_Q_.pop(); }
 	// response channel
-	if (!resp_Q_.empty() && !m_resp_->isStalled()) {
-		m_resp_->push(resp_Q_.front());
-		resp_Q_.pop();
-	}
+	if (!resp_Q_.empty() && this->pushResponse(m_resp_, static_cast<XBarPacket*>(resp_Q_.front()))) { resp_Q_.pop(); }
 }
 
 void SystolicArray::masterPortRetry(const std::string& portName) { trySendPacket(); }
@@ -129,7 +130,7 @@ void SystolicArray::readMMIO(acalsim::Tick when, XBarMemReadReqPayload* req) {
 	                                                req->getA1());
 	resp->setTid(req->getTid());
 	std::vector<XBarMemReadRespPayload*> beats = {resp};
-	auto                                 pkt   = Construct_MemReadRespPkt(beats, "sa", req->getCaller());
+	auto                                 pkt   = Construct_MemReadRespPkt(beats, req->getMaster());
 	resp_Q_.push(pkt);
 	rc->recycle(req);
 }
@@ -144,42 +145,22 @@ void SystolicArray::SRAMReadReqHandler(acalsim::Tick when, XBarMemReadReqPayload
 	operand    a1   = p->getA1();
 	uint32_t   ret  = 0;
 
-	// Base pointer to sram_ as byte array
-	uint8_t* mem     = reinterpret_cast<uint8_t*>(sram_);
-	size_t   memSize = SA_SRAM_SIZE * sizeof(uint32_t);  // 32000 bytes
+	size_t bytes = (op == LB || op == LBU) ? 1 : (op == LH || op == LHU) ? 2 : 4;
 
 	// Check bounds before read
-	if (addr < SA_MEMORY_BASE || addr >= SA_MEMORY_BASE + memSize) {
-		CLASS_ERROR << "SRAM read out of range at 0x" << std::hex << addr;
+	if (addr < SA_MEMORY_BASE || addr - SA_MEMORY_BASE + bytes > sram_.getSize()) {
+		CLASS_ERROR << "SRAM " << instrToString(op) << " read out of range at 0x" << std::hex << addr;
 		return;
 	}
 
 	uint32_t offset = addr - SA_MEMORY_BASE;
 
 	switch (op) {
-		case LB: ret = static_cast<uint32_t>(static_cast<int8_t>(mem[offset])); break;
-		case LBU: ret = static_cast<uint32_t>(mem[offset]); break;
-		case LH:
-			if (offset + 1 >= memSize) {
-				CLASS_ERROR << "SRAM LH read out of bounds at 0x" << std::hex << addr;
-				return;
-			}
-			ret = static_cast<uint32_t>(*reinterpret_cast<int16_t*>(mem + offset));
-			break;
-		case LHU:
-			if (offset + 1 >= memSize) {
-				CLASS_ERROR << "SRAM LHU read out of bounds at 0x" << std::hex << addr;
-				return;
-			}
-			ret = static_cast<uint32_t>(*reinterpret_cast<uint16_t*>(mem + offset));
-			break;
-		case LW:
-			if (offset + 3 >= memSize) {
-				CLASS_ERROR << "SRAM LW read out of bounds at 0x" << std::hex << addr;
-				return;
-			}
-			ret = *reinterpret_cast<uint32_t*>(mem + offset);
-			break;
+		case LB: ret = static_cast<uint32_t>(sram_.load<int8_t>(offset)); break;
+		case LBU: ret = sram_.load<uint8_t>(offset); break;
+		case LH: ret = static_cast<uint32_t>(sram_.load<int16_t>(offset)); break;
+		case LHU: ret = sram_.load<uint16_t>(offset); break;
+		case LW: ret = sram_.load<uint32_t>(offset); break;
 		default: CLASS_ERROR << "Unsupported load OP: " << static_cast<int>(op); return;
 	}
 
@@ -194,7 +175,7 @@ void SystolicArray::SRAMReadReqHandler(acalsim::Tick when, XBarMemReadReqPayload
 	if ((int)tk.rbeats.size() == tk.expected) {
 		auto beats = std::move(tk.rbeats);
 		pending_.erase(p->getTid());
-		auto pkt = Construct_MemReadRespPkt(beats, "sa", p->getCaller());
+		auto pkt = Construct_MemReadRespPkt(beats, p->getMaster());
 		pkt->setTID(p->getTid());
 		resp_Q_.push(pkt);
 	}
@@ -245,7 +226,7 @@ void SystolicArray::writeMMIO(acalsim::Tick when, XBarMemWriteReqPayload* req) {
 	auto resp = rc->acquire<XBarMemWriteRespPayload>(&XBarMemWriteRespPayload::renew, req->getInstr());
 	resp->setTid(req->getTid());
 	std::vector<XBarMemWriteRespPayload*> beats = {resp};
-	auto                                  pkt   = Construct_MemWriteRespPkt(beats, "sa", req->getCaller());
+	auto                                  pkt   = Construct_MemWriteRespPkt(beats, req->getMaster());
 	resp_Q_.push(pkt);
 	rc->recycle(req);
 }
@@ -256,50 +237,24 @@ void SystolicArray::SRAMWriteReqHandler(acalsim::Tick when, XBarMemWriteReqPaylo
 	uint32_t   addr = p->getAddr();
 	uint32_t   dat  = p->getData();
 
-	// Get pointer to SRAM base
-	uint8_t* mem = reinterpret_cast<uint8_t*>(&sram_[0]);
 	assert(addr >= SA_MEMORY_BASE);
 
-	size_t memSize = SA_SRAM_SIZE * sizeof(uint32_t);  // = 32000 bytes
+	size_t bytes = op == SB ? 1 : op == SH ? 2 : 4;
 
 	// Sanity check
-	if (addr < SA_MEMORY_BASE || addr >= SA_MEMORY_BASE + memSize) {
+	if (addr < SA_MEMORY_BASE || addr - SA_MEMORY_BASE + bytes > sram_.getSize()) {
 		LABELED_ERROR(this->getName()) << "SRAM write out of range at 0x" << std::hex << addr;
 		return;
 	}
 
-	// Safe memory write lambda
-	auto writeData = [&](uint32_t addr, const void* data, size_t size) -> bool {
-		int32_t offset = addr - SA_MEMORY_BASE;
-		if (offset < 0 || offset + size > memSize) {
-			LABELED_ERROR(this->getName()) << "SRAM write out of range at 0x" << std::hex << addr;
-			return false;
-		}
-		std::memcpy(mem + offset, data, size);
-		return true;
-	};
-
-	bool ok = false;
+	uint32_t offset = addr - SA_MEMORY_BASE;
 	switch (op) {
-		case SB: {
-			uint8_t byte = dat & 0xFF;
-			ok           = writeData(addr, &byte, sizeof(byte));
-			break;
-		}
-		case SH: {
-			uint16_t half = dat & 0xFFFF;
-			ok            = writeData(addr, &half, sizeof(half));
-			break;
-		}
-		case SW: {
-			ok = writeData(addr, &dat, sizeof(dat));
-			break;
-		}
+		case SB: sram_.store<uint8_t>(offset, dat); break;
+		case SH: sram_.store<uint16_t>(offset, dat); break;
+		case SW: sram_.store<uint32_t>(offset, dat); break;
 		default: LABELED_ERROR(this->getName()) << "Unsupported store OP"; return;
 	}
 
-	if (!ok) return;
-
 	// Send write response
 	auto rc  = acalsim::top->getRecycleContainer();
 	auto rsp = rc->acquire<XBarMemWriteRespPayload>(&XBarMemWriteRespPayload::renew, i);
@@ -311,7 +266,7 @@ void SystolicArray::SRAMWriteReqHandler(acalsim::Tick when, XBarMemWriteReqPaylo
 	if ((int)tk.wbeats.size() == tk.expected) {
 		auto beats = std::move(tk.wbeats);
 		pending_.erase(p->getTid());
-		auto pkt = Construct_MemWriteRespPkt(beats, "sa", p->getCaller());
+		auto pkt = Construct_MemWriteRespPkt(beats, p->getMaster());
 		pkt->setTID(p->getTid());
 		resp_Q_.push(pkt);
 	}
@@ -338,6 +293,7 @@ void SystolicArray::initialized_transaction() {
 	read_MatB_size     = 0;
 	LABELED_ASSERT(expected_MatA_size <= 2048 && expected_MatB_size <= 2048,
 	               "We assumes that matrix size to be less than 2048");
+	LABELED_ASSERT(strideA_ <= 64 && strideB_ <= 64, "The matrix strides must fit the 64x64 staging buffers");
 	for (int i = 0; i < 64; i++) {
 		for (int j = 0; j < 64; j++) {
 			A_matrix[i][j] = 0;
@@ -350,9 +306,9 @@ void SystolicArray::initialized_transaction() {
 }
 
 void SystolicArray::handleReadResponse(XBarMemReadRespPacket* pkt) {
-	auto rc  = acalsim::top->getRecycleContainer();
-	int  src = pkt->getSrcIdx();
-	LABELED_ASSERT(src == 1, "Should from DMA");
+	auto   rc  = acalsim::top->getRecycleContainer();
+	size_t src = pkt->getSrcIdx();
+	LABELED_ASSERT(src == this->slaveIndex(this->dmaBase), "Should from DMA");
 	if (pkt->getPayloads().size() == 1 && pkt->getPayloads()[0]->getA1().imm == 114154) {
 		if (pkt->getPayloads()[0]->getData() == 1) {
 			// DMA finish signal
@@ -363,24 +319,16 @@ void SystolicArray::handleReadResponse(XBarMemReadRespPacket* pkt) {
 			} else if (phase_ == READ_MAT_B) {
 				CLASS_INFO << "DMA Finished MatB loading.";
 				// -------------------- Load A_matrix --------------------
-				for (int i = 0; i < strideA_; ++i) {
-					for (int j = 0; j < strideA_; ++j) {
-						// Each row has strideA_ elements, and 4 elements are in one sram_ word
-						uint32_t word_idx = A_addr_ / 4 + i * ((strideA_ + 3) / 4) + (j / 4);
-						uint32_t word     = sram_[word_idx];
-						uint8_t  value    = (word >> ((j % 4) * 8)) & 0xFF;
-						A_matrix[i][j]    = value;
-					}
+				// Each row holds strideA_ elements padded to whole sram_ words; a row is one contiguous span
+				uint32_t rowBytesA = (strideA_ + 3) / 4 * 4;
+				for (uint32_t i = 0; i < strideA_; ++i) {
+					std::memcpy(A_matrix[i], sram_.view(A_addr_ + i * rowBytesA, strideA_).data(), strideA_);
 				}
 
 				// -------------------- Load B_matrix --------------------
-				for (int i = 0; i < strideB_; ++i) {
-					for (int j = 0; j < strideB_; ++j) {
-						uint32_t word_idx = B_addr_ / 4 + i * ((strideB_ + 3) / 4) + (j / 4);
-						uint32_t word     = sram_[word_idx];
-						uint8_t  value    = (word >> ((j % 4) * 8)) & 0xFF;
-						B_matrix[i][j]    = value;
-					}
+				uint32_t rowBytesB = (strideB_ + 3) / 4 * 4;
+				for (uint32_t i = 0; i < strideB_; ++i) {
+					std::memcpy(B_matrix[i], sram_.view(B_addr_ + i * rowBytesB, strideB_).data(), strideB_);
 				}
 
 				// Print A_matrix
@@ -698,16 +646,13 @@ void SystolicArray::handleWriteCompletion(XBarMemWriteRespPacket* pkt) {
 void SystolicArray::AskDMAtoWrite_matA() {
 	auto rc = acalsim::top->getRecycleContainer();
 
-	instr       dummy;
-	std::string caller = "sa";
+	instr dummy;
 
-	// DMA MMIO base
-	constexpr uint32_t DMA_BASE     = 0x0000F000;
-	constexpr uint32_t DMA_ENABLE   = DMA_BASE + 0x0;
-	constexpr uint32_t DMA_SRC      = DMA_BASE + 0x4;
-	constexpr uint32_t DMA_DST      = DMA_BASE + 0x8;
-	constexpr uint32_t DMA_SIZE_CFG = DMA_BASE + 0xC;
-	constexpr uint32_t DMA_DONE     = DMA_BASE + 0x14;
+	// DMA MMIO registers
+	const uint32_t DMA_ENABLE   = this->dmaBase + 0x0;
+	const uint32_t DMA_SRC      = this->dmaBase + 0x4;
+	const uint32_t DMA_DST      = this->dmaBase + 0x8;
+	const uint32_t DMA_SIZE_CFG = this->dmaBase + 0xC;
 
 	// Prepare values
 	uint32_t src    = A_addr_dm_;
@@ -720,26 +665,23 @@ void SystolicArray::AskDMAtoWrite_matA() {
 	uint8_t  stride   = static_cast<uint8_t>(strideA_ & 0xFF);
 	uint32_t size_cfg = (stride << 24) | (stride << 16) | (TW << 8) | TH;
 	// Issue MMIO writes (non-burst)
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SRC, src, caller));
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_DST, dst, caller));
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SIZE_CFG, size_cfg, caller));
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_ENABLE, enable, caller));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SRC, src));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_DST, dst));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SIZE_CFG, size_cfg));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_ENABLE, enable));
 	this->PokeDMAReady();
 }
 
 void SystolicArray::AskDMAtoWrite_matB() {
 	auto rc = acalsim::top->getRecycleContainer();
 
-	instr       dummy;
-	std::string caller = "sa";
+	instr dummy;
 
-	// DMA MMIO base
-	constexpr uint32_t DMA_BASE     = 0x0000F000;
-	constexpr uint32_t DMA_ENABLE   = DMA_BASE + 0x0;
-	constexpr uint32_t DMA_SRC      = DMA_BASE + 0x4;
-	constexpr uint32_t DMA_DST      = DMA_BASE + 0x8;
-	constexpr uint32_t DMA_SIZE_CFG = DMA_BASE + 0xC;
-	constexpr uint32_t DMA_DONE     = DMA_BASE + 0x14;
+	// DMA MMIO registers
+	const uint32_t DMA_ENABLE   = this->dmaBase + 0x0;
+	const uint32_t DMA_SRC      = this->dmaBase + 0x4;
+	const uint32_t DMA_DST      = this->dmaBase + 0x8;
+	const uint32_t DMA_SIZE_CFG = this->dmaBase + 0xC;
 
 	// Prepare values
 	uint32_t src    = B_addr_dm_;
@@ -752,10 +694,10 @@ void SystolicArray::AskDMAtoWrite_matB() {
 	uint8_t  stride   = static_cast<uint8_t>(strideB_ & 0xFF);
 	uint32_t size_cfg = (stride << 24) | (stride << 16) | (TW << 8) | TH;
 	// Issue MMIO writes (non-burst)
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SRC, src, caller));
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_DST, dst, caller));
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SIZE_CFG, size_cfg, caller));
-	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_ENABLE, enable, caller));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SRC, src));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_DST, dst));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_SIZE_CFG, size_cfg));
+	req_Q_.push(Construct_MemWritepkt_non_burst(dummy, SW, DMA_ENABLE, enable));
 	this->PokeDMAReady();
 }
 
@@ -768,7 +710,7 @@ void SystolicArray::PokeDMAReady() {
 		instr   dummy;
 		operand a1;
 		a1.imm   = 114154;  // Use for tracking
-		auto pkt = Construct_MemReadpkt_non_burst(dummy, LW, 0x0000F014, a1, "sa");
+		auto pkt = Construct_MemReadpkt_non_burst(dummy, LW, this->dmaBase + 0x14 /* DONE */, a1);
 		req_Q_.push(pkt);
 	});
 
@@ -792,8 +734,8 @@ std::string SystolicArray::instrToString(instr_type _op) const {
 }
 
 void SystolicArray::DumpMemory() const {
-	const uint8_t* mem     = reinterpret_cast<const uint8_t*>(sram_);
-	size_t         memSize = 100 * sizeof(uint32_t);  // Total size in bytes
+	size_t memSize = 100 * sizeof(uint32_t);  // Total size in bytes
+	auto   mem     = sram_.view(0, memSize);
 
 	std::cout << "[SystolicArray::DumpMemory] Dumping " << memSize << " bytes of SRAM...\n";
 
@@ -805,7 +747,7 @@ void SystolicArray::DumpMemory() const {
 
 		// Print 8 bytes of data
 		for (int i = 0; i < 8 && (offset + i) < memSize; ++i) {
-			std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(mem[offset + i]) << " ";
+			std::cout << std::hex << std::setw(2) << std::setfill('0') << std::to_integer<int>(mem[offset + i]) << " ";
 		}
 
 		std::cout << "\n";
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "event/CFUResultEvent.hh"
+
+#include "CFU.hh"
+
+CFUResultEvent::CFUResultEvent(CFU* _cfu, CFURespPacket* _pkt)
+    : acalsim::SimEvent("CFUResultEvent"), cfu(_cfu), pkt(_pkt) {}
+
+void CFUResultEvent::renew(CFU* _cfu, CFURespPacket* _pkt) {
+	this->SimEvent::renew();
+	this->cfu = _cfu;
+	this->pkt = _pkt;
+}
+
+void CFUResultEvent::process() { this->cfu->sendResult(this->pkt); }
@@ -0,0 +1,28 @@
+/*
+ * Copyright 2023-2024 Playlab/ACAL
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "event/MemCompletionEvent.hh"
+
+#include "DataMemory.hh"
+
+MemCompletionEvent::MemCompletionEvent(DataMemory* _dm) : acalsim::SimEvent("MemCompletionEvent"), dm(_dm) {}
+
+void MemCompletionEvent::renew(DataMemory* _dm) {
+	this->SimEvent::renew();
+	this->dm = _dm;
+}
+
+void MemCompletionEvent::process() { this->dm->serviceCompletions(); }
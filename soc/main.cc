@@ -24,6 +24,7 @@ int main(int argc, char** argv) {
 	auto start = std::chrono::high_resolution_clock::now();
 	acalsim::top->run();
 	auto stop = std::chrono::high_resolution_clock::now();
+	std::static_pointer_cast<SOC>(acalsim::top)->reportInterconnect();
 
 	auto diff = duration_cast<std::chrono::nanoseconds>(stop - start);
 